@@ -0,0 +1,158 @@
+#include "adaptive.h"
+
+#include <utility>
+
+AdaptiveTree::AdaptiveTree() : nytIndex(ROOT) {
+    leaves.fill(-1);
+    for (Node& n : nodes) n = Node{0, -1, -1, -1, -1};
+}
+
+// Dzieci węzła 'index' wskazują go jako rodzica (po zamianie poddrzew).
+void AdaptiveTree::attach(int index) {
+    Node& n = nodes[index];
+    if (n.left >= 0) {
+        nodes[n.left].parent = index;
+        nodes[n.right].parent = index;
+    } else if (n.symbol >= 0) {
+        leaves[n.symbol] = index;
+    }
+}
+
+/*
+    Zamiana poddrzew na pozycjach a i b (o równych wagach).
+    Rodzic należy do pozycji, więc zamieniamy tylko zawartość węzłów.
+*/
+void AdaptiveTree::swapSubtrees(int a, int b) {
+    std::swap(nodes[a].left, nodes[b].left);
+    std::swap(nodes[a].right, nodes[b].right);
+    std::swap(nodes[a].symbol, nodes[b].symbol);
+    attach(a);
+    attach(b);
+}
+
+void AdaptiveTree::update(int symbol) {
+    int index = leaves[symbol];
+
+    if (index < 0) {
+        // Nowy symbol: NYT staje się węzłem wewnętrznym z dziećmi (nowy NYT, nowy liść).
+        int parent = nytIndex;
+        int newNyt = parent - 2;
+        int leaf = parent - 1;
+
+        nodes[newNyt] = Node{0, parent, -1, -1, -1};
+        nodes[leaf] = Node{0, parent, -1, -1, symbol};
+        nodes[parent].left = newNyt;
+        nodes[parent].right = leaf;
+
+        leaves[symbol] = leaf;
+        nytIndex = newNyt;
+        index = leaf;
+    }
+
+    while (index >= 0) {
+        // Lider bloku: węzeł o największym numerze z tą samą wagą.
+        int leader = index;
+        while (leader + 1 < MAX_NODES && nodes[leader + 1].weight == nodes[index].weight) leader++;
+
+        if (leader != index && leader != nodes[index].parent) {
+            swapSubtrees(index, leader);
+            index = leader;
+        }
+
+        nodes[index].weight++;
+        index = nodes[index].parent;
+    }
+}
+
+// Kod węzła = ścieżka od korzenia (0 = lewe dziecko, 1 = prawe); zbieramy ją od liścia w górę.
+void AdaptiveEncoder::putNode(int index, BitWriter& writer) {
+    uint8_t path[AdaptiveTree::MAX_NODES];
+    int length = 0;
+    for (int i = index; tree.node(i).parent >= 0; i = tree.node(i).parent) {
+        path[length++] = tree.node(tree.node(i).parent).right == i ? 1 : 0;
+    }
+
+    // Kod może być dłuższy niż rejestr BitWriter – dopisujemy go kawałkami po 32 bity.
+    while (length > 0) {
+        int chunk = length < 32 ? length : 32;
+        uint32_t bits = 0;
+        for (int k = 0; k < chunk; ++k) bits = (bits << 1) | path[--length];
+        writer.put(bits, chunk);
+        writer.flush();
+    }
+}
+
+void AdaptiveEncoder::encode(uint8_t symbol, BitWriter& writer) {
+    int leaf = tree.leafOf(symbol);
+    if (leaf >= 0) {
+        putNode(leaf, writer);
+    } else {
+        putNode(tree.nyt(), writer);
+        writer.put(symbol, 9); // bit 0 (nowy symbol) + 8 bitów symbolu
+        writer.flush();
+    }
+    tree.update(symbol);
+}
+
+void AdaptiveEncoder::finish(BitWriter& writer) {
+    putNode(tree.nyt(), writer);
+    writer.put(1, 1);
+    writer.flush();
+}
+
+AdaptiveDecoder::AdaptiveDecoder() : state(TREE), node(AdaptiveTree::ROOT), literal(0), literalBits(0) {
+    restart();
+}
+
+// Początek kolejnego kodu (gdy korzeń jest liściem NYT, od razu czytamy bit flagi).
+void AdaptiveDecoder::restart() {
+    node = AdaptiveTree::ROOT;
+    state = tree.isLeaf(node) ? FLAG : TREE;
+}
+
+void AdaptiveDecoder::onLeaf(std::vector<uint8_t>& out) {
+    if (node == tree.nyt()) {
+        state = FLAG;
+        return;
+    }
+    int symbol = tree.node(node).symbol;
+    out.push_back(static_cast<uint8_t>(symbol));
+    tree.update(symbol);
+    restart();
+}
+
+void AdaptiveDecoder::feed(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < size && state != DONE; ++i) {
+        for (int b = 7; b >= 0 && state != DONE; --b) {
+            int bit = (data[i] >> b) & 1;
+
+            switch (state) {
+                case TREE: {
+                    const AdaptiveTree::Node& n = tree.node(node);
+                    node = bit ? n.right : n.left;
+                    if (tree.isLeaf(node)) onLeaf(out);
+                    break;
+                }
+                case FLAG:
+                    if (bit) {
+                        state = DONE;
+                    } else {
+                        state = LITERAL;
+                        literal = 0;
+                        literalBits = 0;
+                    }
+                    break;
+                case LITERAL:
+                    literal = (literal << 1) | bit;
+                    if (++literalBits == 8) {
+                        out.push_back(static_cast<uint8_t>(literal));
+                        tree.update(literal);
+                        restart();
+                    }
+                    break;
+                case DONE:
+                    break;
+            }
+        }
+    }
+}
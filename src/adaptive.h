@@ -0,0 +1,106 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include "bitio.h"
+#include "canonical.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+  Adaptacyjny (dynamiczny) kod Huffmana – algorytm FGK.
+
+  Koder i dekoder zaczynają od drzewa z jednym liściem NYT ("not yet transmitted")
+  i po każdym symbolu identycznie aktualizują drzewo, więc plik nie potrzebuje
+  nagłówka z kodami, a kodowanie odbywa się w jednym przejściu.
+  - znany symbol: jego bieżący kod,
+  - nowy symbol: kod NYT, bit 0 i 8 bitów symbolu (NYT dzieli się na nowy NYT i liść),
+  - koniec danych: kod NYT i bit 1.
+
+  Drzewo trzyma własność rodzeństwa: węzły są w tablicy w kolejności numerów
+  (większy indeks = waga nie mniejsza, korzeń na końcu). Przed zwiększeniem wagi
+  węzeł zamieniamy z ostatnim węzłem o tej samej wadze (lider bloku).
+*/
+class AdaptiveTree {
+public:
+    // NYT + liść dla każdego symbolu + węzły wewnętrzne.
+    static constexpr int MAX_NODES = 2 * ALPHABET_SIZE + 1;
+    static constexpr int ROOT = MAX_NODES - 1;
+
+    struct Node {
+        uint64_t weight;
+        int parent; // -1 dla korzenia
+        int left;   // -1 dla liścia
+        int right;
+        int symbol; // liść: symbol, NYT: -1
+    };
+
+    AdaptiveTree();
+
+    [[nodiscard]] const Node& node(int index) const { return nodes[index]; }
+    [[nodiscard]] int nyt() const { return nytIndex; }
+    [[nodiscard]] bool isLeaf(int index) const { return nodes[index].left < 0; }
+
+    // Liść symbolu (-1 = symbol jeszcze nie wystąpił).
+    [[nodiscard]] int leafOf(int symbol) const { return leaves[symbol]; }
+
+    // Aktualizacja po zakodowaniu / zdekodowaniu symbolu.
+    void update(int symbol);
+
+private:
+    std::array<Node, MAX_NODES> nodes;
+    std::array<int, ALPHABET_SIZE> leaves;
+    int nytIndex;
+
+    void swapSubtrees(int a, int b);
+    void attach(int index);
+};
+
+// Koder adaptacyjny: dopisuje kody symboli do BitWriter.
+class AdaptiveEncoder {
+public:
+    // Najdłuższy zapis jednego symbolu w bajtach (kod NYT + bit + 8 bitów), z zapasem.
+    static constexpr size_t MAX_SYMBOL_BYTES = (AdaptiveTree::MAX_NODES + 9) / 8 + 1;
+
+    void encode(uint8_t symbol, BitWriter& writer);
+
+    // Znacznik końca danych (kod NYT + bit 1).
+    void finish(BitWriter& writer);
+
+private:
+    AdaptiveTree tree;
+
+    void putNode(int index, BitWriter& writer);
+};
+
+/*
+  Dekoder adaptacyjny przyjmujący dane kawałkami (np. prosto z potoku):
+  stan (bieżący węzeł, bity literału) przechodzi między wywołaniami feed,
+  więc kawałek może się kończyć w środku kodu.
+*/
+class AdaptiveDecoder {
+public:
+    AdaptiveDecoder();
+
+    // Dekoduje bajty i dopisuje odtworzone symbole do 'out'.
+    void feed(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    // Czy odczytano znacznik końca danych.
+    [[nodiscard]] bool finished() const { return state == DONE; }
+
+private:
+    enum State { TREE, FLAG, LITERAL, DONE };
+
+    AdaptiveTree tree;
+    State state;
+    int node;
+    int literal;
+    int literalBits;
+
+    void restart();
+    void onLeaf(std::vector<uint8_t>& out);
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "batch.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+// Plik do przetworzenia: skąd, dokąd i ile bajtów (do podziału pracy).
+struct BatchTask {
+    fs::path input;
+    fs::path output;
+    uint64_t size;
+};
+
+/*
+    Kolejki zadań z podkradaniem pracy (work stealing):
+    każdy wątek ma własną kolejkę i bierze zadania z jej początku, a gdy jest pusta –
+    podkrada z końca kolejki innego wątku. Zadania rozdajemy po kolei od największych,
+    więc właściciel zaczyna od dużych plików, a złodzieje zabierają małe z końca
+    (drobne porcje pracy na koniec wyrównują czasy wątków).
+*/
+class StealingQueues {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+    std::vector<Queue> queues;
+
+public:
+    explicit StealingQueues(size_t workers) : queues(workers) {}
+
+    void push(size_t worker, size_t item) { queues[worker].items.push_back(item); }
+
+    // Kolejne zadanie dla wątku 'worker'; false = nie ma już pracy nigdzie.
+    bool pop(size_t worker, size_t& item) {
+        {
+            Queue& own = queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                item = own.items.front();
+                own.items.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                item = victim.items.back();
+                victim.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static bool hasBatchExtension(const fs::path& path) {
+    return path.extension() == BATCH_EXTENSION;
+}
+
+// Plik albo katalog pominięty przy zbieraniu listy (np. brak uprawnień, plik usunięty w trakcie).
+static void addSkipped(std::vector<BatchError>& errors, const fs::path& path, const std::error_code& ec) {
+    errors.push_back(BatchError{path.string(), "Nie mozna odczytac: " + ec.message()});
+}
+
+/*
+    Pliki z jednego katalogu i (rekurencyjnie) jego podkatalogów. Przeglądamy katalogi sami
+    zamiast recursive_directory_iterator: po błędzie ten iterator staje się końcem, a chcemy
+    pominąć tylko niedostępny katalog. Błędy trafiają do 'errors', jak błędy plików w runBatch.
+*/
+static void collectDirectory(const fs::path& dir, const fs::path& inputDir, const fs::path& outputDir, bool compress,
+                             std::vector<BatchTask>& tasks, std::vector<BatchError>& errors) {
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec) {
+        addSkipped(errors, dir, ec);
+        return;
+    }
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        const fs::directory_entry& entry = *it;
+        // Dowiązań do katalogów nie odwiedzamy (jak recursive_directory_iterator), żeby uniknąć pętli.
+        fs::file_status link = entry.symlink_status(ec);
+        if (!ec && fs::is_directory(link)) {
+            collectDirectory(entry.path(), inputDir, outputDir, compress, tasks, errors);
+            continue;
+        }
+        bool regular = !ec && entry.is_regular_file(ec);
+        if (ec) {
+            addSkipped(errors, entry.path(), ec);
+            ec.clear();
+            continue;
+        }
+        if (!regular) continue;
+        if (!compress && !hasBatchExtension(entry.path())) continue;
+
+        uint64_t size = entry.file_size(ec);
+        if (ec) {
+            addSkipped(errors, entry.path(), ec);
+            ec.clear();
+            continue;
+        }
+        fs::path output = outputDir / entry.path().lexically_relative(inputDir);
+        if (compress) {
+            output += BATCH_EXTENSION;
+        } else {
+            output.replace_extension();
+        }
+        tasks.push_back(BatchTask{entry.path(), output, size});
+    }
+    if (ec) addSkipped(errors, dir, ec);
+}
+
+/*
+    Lista plików z katalogu (rekurencyjnie) z nazwami wyjściowymi.
+    Katalogi wyjściowe tworzymy od razu, na jednym wątku; plik, dla którego się to nie uda,
+    od razu trafia do błędów.
+*/
+static std::vector<BatchTask> collectTasks(const std::string& inputDir, const std::string& outputDir, bool compress,
+                                           std::vector<BatchError>& errors) {
+    if (!fs::is_directory(inputDir)) throw std::runtime_error("Nie jest katalogiem: " + inputDir);
+
+    std::vector<BatchTask> found;
+    collectDirectory(inputDir, inputDir, outputDir, compress, found, errors);
+
+    std::vector<BatchTask> tasks;
+    for (BatchTask& task : found) {
+        std::error_code ec;
+        fs::create_directories(task.output.parent_path(), ec);
+        if (ec) {
+            errors.push_back(BatchError{task.input.string(), "Nie mozna utworzyc katalogu " +
+                                                                 task.output.parent_path().string() + ": " +
+                                                                 ec.message()});
+            continue;
+        }
+        tasks.push_back(std::move(task));
+    }
+    return tasks;
+}
+
+/*
+    Wspólny przebieg obu trybów: 'process' przetwarza jeden plik i zwraca
+    (rawBytes, packedBytes). Wątki puli pracują na kolejkach z podkradaniem,
+    a wyjątek z jednego pliku trafia do listy błędów zamiast przerywać resztę.
+    'skipped' to błędy już ze zbierania listy plików (dołączane do wyniku).
+*/
+static BatchResult runBatch(std::vector<BatchTask>& tasks, std::vector<BatchError> skipped, unsigned threads,
+                            const std::function<std::pair<uint64_t, uint64_t>(const BatchTask&)>& process) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::sort(tasks.begin(), tasks.end(),
+              [](const BatchTask& a, const BatchTask& b) { return a.size > b.size; });
+
+    ThreadPool pool(threads);
+    const size_t workers = pool.size();
+    StealingQueues queues(workers);
+    for (size_t i = 0; i < tasks.size(); ++i) queues.push(i % workers, i);
+
+    std::vector<BatchResult> partial(workers);
+
+    pool.parallelFor(workers, [&](size_t worker) {
+        BatchResult& local = partial[worker];
+        size_t item = 0;
+        while (queues.pop(worker, item)) {
+            const BatchTask& task = tasks[item];
+            try {
+                std::pair<uint64_t, uint64_t> bytes = process(task);
+                local.files++;
+                local.rawBytes += bytes.first;
+                local.packedBytes += bytes.second;
+            } catch (const std::exception& e) {
+                local.errors.push_back(BatchError{task.input.string(), e.what()});
+                std::error_code ignored;
+                fs::remove(task.output, ignored);
+            }
+        }
+    });
+
+    BatchResult result;
+    result.errors = std::move(skipped);
+    for (BatchResult& local : partial) {
+        result.files += local.files;
+        result.rawBytes += local.rawBytes;
+        result.packedBytes += local.packedBytes;
+        for (BatchError& error : local.errors) result.errors.push_back(std::move(error));
+    }
+    std::sort(result.errors.begin(), result.errors.end(),
+              [](const BatchError& a, const BatchError& b) { return a.path < b.path; });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+BatchResult compressDirectory(const std::string& inputDir, const std::string& outputDir,
+                              const CompressOptions& options) {
+    std::vector<BatchError> skipped;
+    std::vector<BatchTask> tasks = collectTasks(inputDir, outputDir, true, skipped);
+
+    // Równolegle działają pliki, więc każdy plik kodujemy jednym wątkiem.
+    CompressOptions single = options;
+    single.threads = 1;
+    return runBatch(tasks, std::move(skipped), options.threads, [&](const BatchTask& task) {
+        CompressStats stats = compressFile(task.input.string(), task.output.string(), single);
+        return std::make_pair(stats.inputBytes, stats.outputBytes);
+    });
+}
+
+BatchResult decompressDirectory(const std::string& inputDir, const std::string& outputDir,
+                                const DecompressOptions& options) {
+    std::vector<BatchError> skipped;
+    std::vector<BatchTask> tasks = collectTasks(inputDir, outputDir, false, skipped);
+
+    DecompressOptions single = options;
+    single.threads = 1;
+    return runBatch(tasks, std::move(skipped), options.threads, [&](const BatchTask& task) {
+        uint64_t raw = decompressFile(task.input.string(), task.output.string(), single);
+        return std::make_pair(raw, task.size);
+    });
+}
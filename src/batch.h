@@ -0,0 +1,44 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "huffman.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+  Tryb katalogowy: wiele plików w jednym uruchomieniu programu.
+
+  Pliki (rekurencyjnie, tylko zwykłe pliki) są przetwarzane równolegle – każdy
+  w całości na jednym wątku – a błąd jednego pliku nie przerywa pozostałych.
+  Niedostępne podkatalogi i pliki znikające w trakcie też są tylko zgłaszane jako błędy.
+  Struktura podkatalogów jest zachowana w katalogu wyjściowym:
+  - kompresja:   <in>/a/b.txt   -> <out>/a/b.txt.huf
+  - dekompresja: <in>/a/b.txt.huf -> <out>/a/b.txt (pliki bez .huf są pomijane)
+*/
+
+// Plik, którego nie udało się przetworzyć (jego częściowy wynik jest usuwany).
+struct BatchError {
+    std::string path;
+    std::string message;
+};
+
+struct BatchResult {
+    size_t files = 0;         // pliki przetworzone poprawnie
+    uint64_t rawBytes = 0;    // bajty przed kompresją / po dekompresji
+    uint64_t packedBytes = 0; // bajty plików .huf
+    double seconds = 0;       // czas całej operacji (zegar ścienny)
+    std::vector<BatchError> errors;
+};
+
+// Rozszerzenie plików skompresowanych w trybie katalogowym.
+constexpr const char* BATCH_EXTENSION = ".huf";
+
+// options.threads = liczba plików przetwarzanych naraz (0 = liczba rdzeni).
+BatchResult compressDirectory(const std::string& inputDir, const std::string& outputDir,
+                              const CompressOptions& options = {});
+BatchResult decompressDirectory(const std::string& inputDir, const std::string& outputDir,
+                                const DecompressOptions& options = {});
+
+#endif
@@ -0,0 +1,776 @@
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "huffman.h"
+#include "io.h"
+#include "decoder.h"
+#include "encoder.h"
+#include "histogram.h"
+#include "format.h"
+#include "threadpool.h"
+#include "minheap.h"
+#include "crc32c.h"
+
+namespace fs = std::filesystem;
+
+/*
+  Benchmark kodowania i dekodowania na kilku syntetycznych wejściach:
+  - zliczanie: dawna mapa haszująca vs płaski histogram (1 wątek / pula wątków),
+  - budowa drzewa: kopiec vs dwie kolejki dla różnej liczby symboli,
+  - MinHeap: porównanie przez wskaźnik na funkcję (2-arny) vs obiekt funkcyjny (2- i 4-arny)
+    na operacjach kopca z budowy drzewa i z runHeapDemo (także elementy tylko-do-przenoszenia),
+  - kodowanie: dawna pętla bit po bicie vs EncodeTable (1 kod na flush / rozwinięta pętla),
+  - dekodowanie: dawny dekoder bit po bicie (decodeBitByBit) vs DecodeTable,
+  - suma kontrolna CRC32C: programowo (slicing-by-8) vs instrukcja SSE4.2.
+
+  Tryb "corpus" mierzy kolejne etapy kodeka na zestawie plików (syntetycznych
+  albo z katalogu) i wypisuje wyniki jako tekst, JSON albo CSV – do porównywania
+  wyników między commitami.
+
+  Uzycie: huffman-bench [rozmiar_w_MB]
+          huffman-bench corpus [--size=MB] [--dir=KATALOG] [--repeat=N]
+                               [--format=text|json|csv] [--output=PLIK]
+*/
+
+// Tekst z losowych słów o rozkładzie zbliżonym do naturalnego (częste słowa krótkie).
+static std::string makeText(size_t size, std::mt19937& rng) {
+    static const char* words[] = {
+        "the", "of", "and", "to", "in", "is", "that", "for", "it", "as",
+        "with", "was", "on", "be", "by", "this", "are", "from", "at", "or",
+        "huffman", "compression", "decoder", "table", "stream", "error", "request", "value"
+    };
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+    std::geometric_distribution<size_t> pick(0.15);
+
+    std::string text;
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        text += words[pick(rng) % wordCount];
+        text += (rng() % 12 == 0) ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+// Bajty o silnie nierównym rozkładzie (długie kody dla rzadkich symboli).
+static std::string makeSkewed(size_t size, std::mt19937& rng) {
+    std::geometric_distribution<int> pick(0.3);
+    std::string text(size, '\0');
+    for (char& c : text) c = static_cast<char>(pick(rng) % 256);
+    return text;
+}
+
+// Bajty z rozkładu jednostajnego (kody ~8 bitów).
+static std::string makeRandom(size_t size, std::mt19937& rng) {
+    std::string text(size, '\0');
+    for (char& c : text) c = static_cast<char>(rng() & 0xFF);
+    return text;
+}
+
+// Rekordy binarne (jak w logach/pomiarach): rosnący licznik, małe liczby, dużo zer.
+static std::string makeBinary(size_t size, std::mt19937& rng) {
+    std::string data;
+    data.reserve(size + 16);
+    uint32_t id = 0;
+    uint32_t time = 1700000000;
+    std::geometric_distribution<uint32_t> delta(0.2);
+    while (data.size() < size) {
+        uint8_t record[16] = {};
+        time += delta(rng);
+        for (int b = 0; b < 4; ++b) record[b] = static_cast<uint8_t>(id >> (8 * b));
+        for (int b = 0; b < 4; ++b) record[4 + b] = static_cast<uint8_t>(time >> (8 * b));
+        record[8] = static_cast<uint8_t>(rng() % 8);
+        record[9] = static_cast<uint8_t>(delta(rng));
+        record[12] = static_cast<uint8_t>(rng() % 3 == 0 ? 0xFF : 0);
+        data.append(reinterpret_cast<const char*>(record), sizeof(record));
+        id++;
+    }
+    data.resize(size);
+    return data;
+}
+
+// Dawna pętla kodująca: kod bit po bicie, push_back dla każdego bajtu.
+static uint64_t encodeBitByBit(const std::string& text, const EncodeTable& table, std::vector<uint8_t>& data) {
+    uint8_t currentByte = 0;
+    int bitPos = 0;
+    uint64_t bitCount = 0;
+
+    for (char c : text) {
+        const EncodeEntry& code = table[static_cast<uint8_t>(c)];
+        for (int b = static_cast<int>(code.length) - 1; b >= 0; --b) {
+            currentByte = static_cast<uint8_t>((currentByte << 1) | ((code.code >> b) & 1));
+            bitPos++;
+            bitCount++;
+            if (bitPos == 8) {
+                data.push_back(currentByte);
+                currentByte = 0;
+                bitPos = 0;
+            }
+        }
+    }
+    if (bitPos > 0) data.push_back(static_cast<uint8_t>(currentByte << (8 - bitPos)));
+    return bitCount;
+}
+
+// Dawne zliczanie częstotliwości: wyszukiwanie w mapie dla każdego bajtu.
+static std::unordered_map<char, int> countFrequenciesMap(const std::string& text) {
+    std::unordered_map<char, int> freq;
+    for (char c : text) freq[c]++;
+    return freq;
+}
+
+template <typename F>
+static double seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+static void runCase(const std::string& name, const std::string& text, const fs::path& dir) {
+    fs::path in  = dir / (name + ".txt");
+    fs::path out = dir / (name + ".huf");
+
+    // Dekoder referencyjny potrzebuje słownika "010" -> znak, więc zapisujemy stary format.
+    CompressOptions options;
+    options.legacyFormat = true;
+
+    writeTextToFile(in.string(), text);
+    compressFile(in.string(), out.string(), options);
+    CompressedData cd = readCompressedFile(out.string());
+
+    std::string reference;
+    double tRef = seconds([&] { reference = decodeBitByBit(cd); });
+
+    std::string decoded;
+    double tTable = seconds([&] {
+        DecodeTable table = DecodeTable::fromDictionary(cd.reverseDict);
+        table.decode(cd.data.data(), cd.data.size(), cd.bitCount, decoded);
+    });
+
+    if (reference != text || decoded != text) {
+        throw std::runtime_error("Benchmark: wynik dekodowania rozni sie od wejscia (" + name + ")");
+    }
+
+    // Kodowanie: długości kodów ze słownika (kody kanoniczne), trzy warianty pętli.
+    CodeLengths lengths{};
+    for (const auto& [bits, ch] : cd.reverseDict) lengths[static_cast<uint8_t>(ch)] = static_cast<uint8_t>(bits.size());
+    EncodeTable encoder = EncodeTable::fromCodeLengths(lengths);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+
+    std::vector<uint8_t> refData, oneData, unrolledData;
+    uint64_t refBits = 0, oneBits = 0, unrolledBits = 0;
+    double tEncRef = seconds([&] { refBits = encodeBitByBit(text, encoder, refData); });
+    double tEncOne = seconds([&] { oneBits = encoder.encode(bytes, text.size(), oneData, 1); });
+    double tEncUnrolled = seconds([&] { unrolledBits = encoder.encode(bytes, text.size(), unrolledData); });
+
+    if (refData != oneData || refData != unrolledData || refBits != oneBits || refBits != unrolledBits) {
+        throw std::runtime_error("Benchmark: warianty kodowania daja rozne wyniki (" + name + ")");
+    }
+
+    // Dekodowanie do bufora: jeden strumień vs INTERLEAVE segmentów (jak w bloku z BLOCK_SEGMENTS).
+    DecodeTable canonical = DecodeTable::fromCodeLengths(lengths);
+    const size_t segments = DecodeTable::INTERLEAVE;
+    const size_t segmentSize = (text.size() + segments - 1) / segments;
+    std::vector<uint8_t> segData;
+    std::vector<uint64_t> segBits;
+    for (size_t first = 0; first < text.size(); first += segmentSize) {
+        segBits.push_back(encoder.encode(bytes + first, std::min(segmentSize, text.size() - first), segData));
+    }
+
+    std::vector<uint8_t> single(text.size()), interleaved(text.size());
+    std::vector<DecodeTable::Stream> streams;
+    size_t offset = 0;
+    for (size_t i = 0; i < segBits.size(); ++i) {
+        size_t first = i * segmentSize;
+        streams.push_back(DecodeTable::Stream{segData.data() + offset, segData.size() - offset, segBits[i],
+                                              interleaved.data() + first, std::min(segmentSize, text.size() - first)});
+        offset += (segBits[i] + 7) / 8;
+    }
+
+    double tSingle = seconds([&] { canonical.decode(oneData.data(), oneData.size(), oneBits, single.data(), single.size()); });
+    double tStreams = seconds([&] { canonical.decodeStreams(streams.data(), streams.size()); });
+
+    if (std::memcmp(single.data(), bytes, text.size()) != 0 || single != interleaved) {
+        throw std::runtime_error("Benchmark: dekodowanie strumieni rozni sie od wejscia (" + name + ")");
+    }
+
+    // Zliczanie bajtów: wszystkie warianty muszą dać te same liczby.
+    std::unordered_map<char, int> mapFreq;
+    Histogram flat{}, parallel{};
+    ThreadPool pool;
+    double tCountMap = seconds([&] { mapFreq = countFrequenciesMap(text); });
+    double tCountFlat = seconds([&] { flat = countHistogram(bytes, text.size()); });
+    double tCountParallel = seconds([&] { parallel = countHistogram(bytes, text.size(), pool); });
+
+    for (int c = 0; c < ALPHABET_SIZE; ++c) {
+        auto it = mapFreq.find(static_cast<char>(c));
+        uint64_t expected = it == mapFreq.end() ? 0 : static_cast<uint64_t>(it->second);
+        if (flat[c] != expected || parallel[c] != expected) {
+            throw std::runtime_error("Benchmark: histogramy roznia sie (" + name + ")");
+        }
+    }
+
+    // CRC32C (--checksum): obie wersje muszą dać tę samą sumę.
+    uint32_t crcSoftware = 0, crcDefault = 0;
+    double tCrcSoftware = seconds([&] { crcSoftware = crc32cSoftware(bytes, text.size()); });
+    double tCrc = seconds([&] { crcDefault = crc32c(bytes, text.size()); });
+    if (crcSoftware != crcDefault) throw std::runtime_error("Benchmark: sumy CRC32C roznia sie (" + name + ")");
+
+    double mb = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(1)
+              << std::left << std::setw(8) << name << " zliczanie:"
+              << "    mapa: " << std::setw(8) << mb / tCountMap << " MB/s"
+              << "   histogram: " << std::setw(8) << mb / tCountFlat << " MB/s"
+              << "   pula(" << pool.size() << "): " << std::setw(8) << mb / tCountParallel << " MB/s\n"
+              << std::setw(8) << name << " kodowanie:"
+              << "   bit-po-bicie: " << std::setw(8) << mb / tEncRef << " MB/s"
+              << "   1 kod/flush: " << std::setw(8) << mb / tEncOne << " MB/s"
+              << "   rozwiniety: " << std::setw(8) << mb / tEncUnrolled << " MB/s\n"
+              << std::setw(8) << name << " dekodowanie:"
+              << " bit-po-bicie: " << std::setw(8) << mb / tRef << " MB/s"
+              << "   tablicowy: " << std::setw(8) << mb / tTable << " MB/s"
+              << "   przyspieszenie: x" << tRef / tTable << "\n"
+              << std::setw(8) << name << " do bufora:"
+              << "   1 strumien: " << std::setw(8) << mb / tSingle << " MB/s"
+              << "   " << segments << " strumienie: " << std::setw(8) << mb / tStreams << " MB/s"
+              << "   przyspieszenie: x" << tSingle / tStreams << "\n"
+              << std::setw(8) << name << " crc32c:"
+              << "      programowy: " << std::setw(8) << mb / tCrcSoftware << " MB/s"
+              << "   " << (crc32cHardware() ? "SSE4.2" : "(brak SSE4.2)") << ": " << std::setw(8) << mb / tCrc
+              << " MB/s\n";
+}
+
+// Koszt drzewa (łączna liczba bitów danych) = suma częstotliwości węzłów wewnętrznych.
+static uint64_t treeCost(const HuffmanTree& tree) {
+    uint64_t cost = 0;
+    for (int i = 0; i < tree.count; ++i) {
+        if (tree.nodes[i].left >= 0) cost += tree.nodes[i].freq;
+    }
+    return cost;
+}
+
+// Budowa drzewa dla losowych histogramów o 'symbols' symbolach (tak jak przy każdym bloku).
+static void runTreeCase(int symbols, std::mt19937& rng) {
+    constexpr int ROUNDS = 20000;
+    std::vector<Histogram> hists(64, Histogram{});
+    std::geometric_distribution<uint64_t> pick(0.001);
+    for (Histogram& h : hists) {
+        for (int c = 0; c < symbols; ++c) h[c] = 1 + pick(rng);
+    }
+
+    HuffmanTree heapTree, queueTree;
+    uint64_t heapCost = 0, queueCost = 0;
+    double tHeap = seconds([&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            buildHuffmanTreeHeap(hists[r % hists.size()], heapTree);
+            heapCost += treeCost(heapTree);
+        }
+    });
+    double tQueue = seconds([&] {
+        for (int r = 0; r < ROUNDS; ++r) {
+            buildHuffmanTreeTwoQueue(hists[r % hists.size()], queueTree);
+            queueCost += treeCost(queueTree);
+        }
+    });
+
+    if (heapCost != queueCost) throw std::runtime_error("Benchmark: drzewa maja rozny koszt");
+
+    std::cout << std::fixed << std::setprecision(0)
+              << "drzewo " << std::setw(3) << symbols << " symboli:"
+              << "   kopiec: " << std::setw(6) << 1e9 * tHeap / ROUNDS << " ns"
+              << "   dwie kolejki: " << std::setw(6) << 1e9 * tQueue / ROUNDS << " ns\n";
+}
+
+// Element kopca jak przy budowie drzewa Huffmana.
+struct HeapBenchItem {
+    uint64_t freq;
+    int node;
+};
+
+static bool lessHeapBenchItem(const HeapBenchItem& a, const HeapBenchItem& b) {
+    return a.freq < b.freq;
+}
+
+struct HeapBenchLess {
+    bool operator()(const HeapBenchItem& a, const HeapBenchItem& b) const { return a.freq < b.freq; }
+};
+
+// Element jak w runHeapDemo (nazwa + priorytet).
+struct DemoBenchItem {
+    std::string name;
+    int priority;
+};
+
+static bool lessDemoBenchItem(const DemoBenchItem& a, const DemoBenchItem& b) {
+    return a.priority < b.priority;
+}
+
+struct DemoBenchLess {
+    bool operator()(const DemoBenchItem& a, const DemoBenchItem& b) const { return a.priority < b.priority; }
+    bool operator()(const std::unique_ptr<DemoBenchItem>& a, const std::unique_ptr<DemoBenchItem>& b) const {
+        return a->priority < b->priority;
+    }
+};
+
+// Operacje kopca z budowy drzewa: buildFromArray, potem extractMin x2 + insert aż zostanie korzeń.
+template <typename Heap, typename... Args>
+static uint64_t huffmanHeapWorkload(const std::vector<HeapBenchItem>& leaves, Args... cmp) {
+    Heap heap(leaves.size(), cmp...);
+    heap.buildFromArray(leaves.data(), leaves.size());
+    uint64_t cost = 0;
+    int next = static_cast<int>(leaves.size());
+    while (heap.getSize() > 1) {
+        HeapBenchItem a = heap.extractMin();
+        HeapBenchItem b = heap.extractMin();
+        cost += a.freq + b.freq;
+        heap.insert(HeapBenchItem{a.freq + b.freq, next++});
+    }
+    return cost;
+}
+
+// Operacje jak w runHeapDemo, ale na wielu elementach: build, insert, decreaseKey, extractMin.
+template <typename Heap, typename Make, typename Key, typename... Args>
+static int64_t demoHeapWorkload(const std::vector<int>& priorities, Make make, Key key, Args... cmp) {
+    size_t half = priorities.size() / 2;
+    Heap heap(priorities.size(), cmp...);
+
+    using Item = decltype(make(0));
+    std::vector<Item> initial;
+    for (size_t i = 0; i < half; ++i) initial.push_back(make(priorities[i]));
+    heap.buildFromArray(std::move(initial));
+
+    for (size_t i = half; i < priorities.size(); ++i) {
+        heap.insert(make(priorities[i]));
+        if (i % 4 == 0) heap.decreaseKey(0, make(key(heap.peekMin()) - 1000));
+    }
+
+    int64_t checksum = 0;
+    int64_t previous = INT64_MIN;
+    while (!heap.isEmpty()) {
+        int priority = key(heap.extractMin());
+        if (priority < previous) throw std::runtime_error("Benchmark: kopiec zwrocil elementy w zlej kolejnosci");
+        previous = priority;
+        checksum = checksum * 31 + priority;
+    }
+    return checksum;
+}
+
+static void runHeapCase(std::mt19937& rng) {
+    using FnHeap = MinHeap<HeapBenchItem>;
+    using Inline2 = MinHeap<HeapBenchItem, HeapBenchLess, 2>;
+    using Inline4 = MinHeap<HeapBenchItem, HeapBenchLess, 4>;
+
+    // Budowa drzewa: 256 symboli, wiele powtórzeń.
+    constexpr int TREE_ROUNDS = 20000;
+    std::vector<HeapBenchItem> leaves;
+    std::geometric_distribution<uint64_t> pick(0.001);
+    for (int c = 0; c < ALPHABET_SIZE; ++c) leaves.push_back(HeapBenchItem{1 + pick(rng), c});
+
+    uint64_t costFn = 0, cost2 = 0, cost4 = 0;
+    double tFn = seconds([&] {
+        for (int r = 0; r < TREE_ROUNDS; ++r) costFn += huffmanHeapWorkload<FnHeap>(leaves, lessHeapBenchItem);
+    });
+    double t2 = seconds([&] {
+        for (int r = 0; r < TREE_ROUNDS; ++r) cost2 += huffmanHeapWorkload<Inline2>(leaves);
+    });
+    double t4 = seconds([&] {
+        for (int r = 0; r < TREE_ROUNDS; ++r) cost4 += huffmanHeapWorkload<Inline4>(leaves);
+    });
+    if (costFn != cost2 || costFn != cost4) throw std::runtime_error("Benchmark: kopce daja rozne drzewa");
+
+    std::cout << std::fixed << std::setprecision(0)
+              << "kopiec (drzewo, 256 symboli):  wskaznik/2: " << std::setw(6) << 1e9 * tFn / TREE_ROUNDS << " ns"
+              << "   inline/2: " << std::setw(6) << 1e9 * t2 / TREE_ROUNDS << " ns"
+              << "   inline/4: " << std::setw(6) << 1e9 * t4 / TREE_ROUNDS << " ns\n";
+
+    // Operacje z runHeapDemo na 200 tys. elementów (string + priorytet).
+    std::vector<int> priorities(200000);
+    for (int& p : priorities) p = static_cast<int>(rng() % 1000000);
+
+    auto makeDemo = [](int p) { return DemoBenchItem{"item", p}; };
+    auto keyDemo = [](const DemoBenchItem& x) { return x.priority; };
+    auto makeOwned = [](int p) { return std::make_unique<DemoBenchItem>(DemoBenchItem{"item", p}); };
+    auto keyOwned = [](const std::unique_ptr<DemoBenchItem>& x) { return x->priority; };
+
+    int64_t sumFn = 0, sum2 = 0, sum4 = 0, sumOwned = 0;
+    double tDemoFn = seconds([&] {
+        sumFn = demoHeapWorkload<MinHeap<DemoBenchItem>>(priorities, makeDemo, keyDemo, lessDemoBenchItem);
+    });
+    double tDemo2 = seconds([&] {
+        sum2 = demoHeapWorkload<MinHeap<DemoBenchItem, DemoBenchLess, 2>>(priorities, makeDemo, keyDemo);
+    });
+    double tDemo4 = seconds([&] {
+        sum4 = demoHeapWorkload<MinHeap<DemoBenchItem, DemoBenchLess, 4>>(priorities, makeDemo, keyDemo);
+    });
+    double tOwned = seconds([&] {
+        sumOwned = demoHeapWorkload<MinHeap<std::unique_ptr<DemoBenchItem>, DemoBenchLess, 4>>(
+            priorities, makeOwned, keyOwned);
+    });
+    if (sumFn != sum2 || sumFn != sum4 || sumFn != sumOwned) {
+        throw std::runtime_error("Benchmark: kopce daja rozne wyniki (demo)");
+    }
+
+    std::cout << std::setprecision(1)
+              << "kopiec (demo, 200 tys.):       wskaznik/2: " << std::setw(6) << 1e3 * tDemoFn << " ms"
+              << "   inline/2: " << std::setw(6) << 1e3 * tDemo2 << " ms"
+              << "   inline/4: " << std::setw(6) << 1e3 * tDemo4 << " ms"
+              << "   unique_ptr/4: " << std::setw(6) << 1e3 * tOwned << " ms\n";
+}
+
+/*
+    Tryb corpus: etapy kodeka mierzone osobno na jednym bloku (cały plik wejściowy,
+    segmenty jak w formacie blokowym), a na końcu pełna kompresja i dekompresja pliku.
+    Każdy etap powtarzamy 'repeat' razy i bierzemy najlepszy czas.
+*/
+struct PhaseTime {
+    std::string phase;
+    double seconds;
+};
+
+struct CorpusResult {
+    std::string name;
+    size_t bytes = 0;
+    size_t fileBytes = 0; // rozmiar pliku .huf z compressFile
+    size_t wideBytes = 0; // rozmiar wyniku z --symbol-bits=16 (w pamięci)
+    std::vector<PhaseTime> phases;
+};
+
+struct CorpusOptions {
+    size_t sizeMb = 8;
+    std::string dir;              // pliki z katalogu zamiast danych syntetycznych
+    int repeat = 3;
+    std::string format = "text";  // text | json | csv
+    std::string output;           // pusty = stdout
+};
+
+template <typename F>
+static double bestOf(int repeat, F&& f) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repeat; ++r) best = std::min(best, seconds(f));
+    return best;
+}
+
+static CorpusResult measureCorpus(const std::string& name, const std::vector<uint8_t>& data, int repeat,
+                                  const fs::path& dir) {
+    const uint8_t* bytes = data.data();
+    const size_t size = data.size();
+    CorpusResult result{name, size, 0, 0, {}};
+
+    Histogram hist{};
+    HuffmanTree tree;
+    CodeLengths lengths{};
+    EncodeTable encoder;
+
+    double tCount = bestOf(repeat, [&] { hist = countHistogram(bytes, size); });
+    double tTree = bestOf(repeat, [&] { buildHuffmanTree(hist, tree); });
+    double tCodes = bestOf(repeat, [&] {
+        lengths.fill(0);
+        computeCodeLengths(tree, lengths);
+        if (*std::max_element(lengths.begin(), lengths.end()) > DEFAULT_MAX_CODE_LENGTH) {
+            packageMerge(hist, DEFAULT_MAX_CODE_LENGTH, lengths);
+        }
+        encoder = EncodeTable::fromCodeLengths(lengths);
+    });
+
+    // Jeden blok z DEFAULT_STREAMS segmentami (jak domyślna kompresja).
+    BlockHeader block;
+    block.rawSize = static_cast<uint32_t>(size);
+    block.flags = BLOCK_OWN_TABLE;
+    block.lengths = lengths;
+    if (size >= DEFAULT_STREAMS * MIN_SEGMENT_SIZE) {
+        block.flags |= BLOCK_SEGMENTS;
+        block.segmentSize = static_cast<uint32_t>((size + DEFAULT_STREAMS - 1) / DEFAULT_STREAMS);
+    } else {
+        block.segmentSize = static_cast<uint32_t>(size);
+    }
+    block.segmentBits.assign(BlockHeader::segmentCount(block.rawSize, block.segmentSize), 0);
+
+    std::vector<uint8_t> payload;
+    double tEncode = bestOf(repeat, [&] {
+        payload.clear();
+        for (size_t i = 0; i < block.segmentBits.size(); ++i) {
+            size_t first = i * block.segmentSize;
+            size_t count = std::min<size_t>(block.segmentSize, size - first);
+            block.segmentBits[i] = static_cast<uint32_t>(encoder.encode(bytes + first, count, payload));
+        }
+    });
+    if (!(block.flags & BLOCK_SEGMENTS)) block.bitCount = block.segmentBits[0];
+
+    std::vector<uint8_t> header;
+    double tHeader = bestOf(repeat, [&] {
+        header.clear();
+        appendBlockHeader(header, block);
+    });
+
+    std::vector<uint8_t> decoded(size);
+    std::vector<DecodeTable::Stream> streams;
+    size_t offset = 0;
+    for (size_t i = 0; i < block.segmentBits.size(); ++i) {
+        size_t first = i * block.segmentSize;
+        streams.push_back(DecodeTable::Stream{payload.data() + offset, payload.size() - offset, block.segmentBits[i],
+                                              decoded.data() + first, std::min<size_t>(block.segmentSize, size - first)});
+        offset += (block.segmentBits[i] + 7) / 8;
+    }
+    double tDecode = bestOf(repeat, [&] {
+        DecodeTable table = DecodeTable::fromCodeLengths(lengths);
+        table.decodeStreams(streams.data(), streams.size());
+    });
+    if (decoded != data) throw std::runtime_error("Benchmark: dekodowanie rozni sie od wejscia (" + name + ")");
+
+    // Cały plik: format blokowy z domyślnymi opcjami, odczyt i zapis na dysku.
+    fs::path in = dir / (name + ".txt");
+    fs::path packed = dir / (name + ".huf");
+    fs::path restored = dir / (name + ".out");
+    writeBinaryFile(in.string(), data);
+    double tCompress = bestOf(repeat, [&] {
+        compressFile(in.string(), packed.string());
+    });
+    double tDecompress = bestOf(repeat, [&] {
+        decompressFile(packed.string(), restored.string());
+    });
+    if (readBinaryFile(restored.string()) != data) {
+        throw std::runtime_error("Benchmark: plik po dekompresji rozni sie od wejscia (" + name + ")");
+    }
+    result.fileBytes = static_cast<size_t>(fs::file_size(packed));
+
+    // To samo w pamięci: Compressor/Decompressor używane ponownie (bez wątków i buforów od nowa).
+    Compressor compressor;
+    Decompressor decompressor;
+    std::vector<uint8_t> compressed, restoredData;
+    double tCompressMemory = bestOf(repeat, [&] { compressor.compress(bytes, size, compressed); });
+    double tDecompressMemory = bestOf(repeat, [&] {
+        decompressor.decompress(compressed.data(), compressed.size(), restoredData);
+    });
+    if (restoredData != data) {
+        throw std::runtime_error("Benchmark: dekompresja w pamieci rozni sie od wejscia (" + name + ")");
+    }
+
+    // Koszt --checksum: sama suma CRC32C i kompresja/dekompresja w pamięci z sumami bloków i pliku.
+    uint32_t crc = 0;
+    double tChecksum = bestOf(repeat, [&] { crc = crc32c(bytes, size); });
+    CompressOptions checked;
+    checked.checksum = true;
+    Compressor checkedCompressor(checked);
+    double tCompressChecked = bestOf(repeat, [&] { checkedCompressor.compress(bytes, size, compressed); });
+    double tDecompressChecked = bestOf(repeat, [&] {
+        decompressor.decompress(compressed.data(), compressed.size(), restoredData);
+    });
+    if (restoredData != data || crc != crc32cSoftware(bytes, size)) {
+        throw std::runtime_error("Benchmark: dekompresja z suma kontrolna rozni sie od wejscia (" + name + ")");
+    }
+
+    // --symbol-bits=16: bloki z parami bajtów (rozmiar wyniku i szybkość obu kierunków).
+    CompressOptions wide;
+    wide.symbolBits = 16;
+    Compressor wideCompressor(wide);
+    double tCompressWide = bestOf(repeat, [&] { wideCompressor.compress(bytes, size, compressed); });
+    double tDecompressWide = bestOf(repeat, [&] {
+        decompressor.decompress(compressed.data(), compressed.size(), restoredData);
+    });
+    if (restoredData != data) {
+        throw std::runtime_error("Benchmark: dekompresja par bajtow rozni sie od wejscia (" + name + ")");
+    }
+    result.wideBytes = compressed.size();
+
+    result.phases = {{"count", tCount},   {"tree", tTree},     {"codes", tCodes},
+                     {"encode", tEncode}, {"header", tHeader}, {"decode", tDecode},
+                     {"compress-file", tCompress}, {"decompress-file", tDecompress},
+                     {"compress-memory", tCompressMemory}, {"decompress-memory", tDecompressMemory},
+                     {"crc32c", tChecksum}, {"compress-memory-crc", tCompressChecked},
+                     {"decompress-memory-crc", tDecompressChecked}, {"compress-memory-wide", tCompressWide},
+                     {"decompress-memory-wide", tDecompressWide}};
+    return result;
+}
+
+static double ratioOf(const CorpusResult& r) {
+    return r.bytes == 0 ? 0.0 : static_cast<double>(r.fileBytes) / static_cast<double>(r.bytes);
+}
+
+static double mbPerSecond(const CorpusResult& r, const PhaseTime& p) {
+    return p.seconds > 0 ? static_cast<double>(r.bytes) / (1024.0 * 1024.0) / p.seconds : 0.0;
+}
+
+static double nsPerByte(const CorpusResult& r, const PhaseTime& p) {
+    return r.bytes == 0 ? 0.0 : 1e9 * p.seconds / static_cast<double>(r.bytes);
+}
+
+// Nazwa pliku jako napis JSON (cudzysłowy, ukośniki i znaki sterujące).
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void printCorpusText(std::ostream& out, const std::vector<CorpusResult>& results) {
+    for (const CorpusResult& r : results) {
+        out << std::fixed << std::setprecision(3) << r.name << ": " << r.bytes << " B -> " << r.fileBytes
+            << " B (wspolczynnik " << ratioOf(r) << "), --symbol-bits=16: " << r.wideBytes << " B\n";
+        for (const PhaseTime& p : r.phases) {
+            out << "  " << std::left << std::setw(22) << p.phase << std::right << std::setprecision(1)
+                << std::setw(10) << mbPerSecond(r, p) << " MB/s" << std::setprecision(3)
+                << std::setw(10) << nsPerByte(r, p) << " ns/B" << std::setprecision(1)
+                << std::setw(12) << 1e6 * p.seconds << " us\n";
+        }
+    }
+}
+
+static void printCorpusJson(std::ostream& out, const std::vector<CorpusResult>& results, const CorpusOptions& options) {
+    out << std::setprecision(9) << "{\n  \"repeat\": " << options.repeat << ",\n  \"corpus\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CorpusResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\"name\": " << jsonString(r.name) << ", \"bytes\": " << r.bytes
+            << ", \"compressed_bytes\": " << r.fileBytes << ", \"ratio\": " << ratioOf(r)
+            << ", \"compressed_bytes_wide\": " << r.wideBytes << ", \"phases\": [";
+        for (size_t k = 0; k < r.phases.size(); ++k) {
+            const PhaseTime& p = r.phases[k];
+            out << (k ? "," : "") << "\n      {\"phase\": \"" << p.phase << "\", \"seconds\": " << p.seconds
+                << ", \"mb_per_s\": " << mbPerSecond(r, p) << ", \"ns_per_byte\": " << nsPerByte(r, p) << "}";
+        }
+        out << "\n    ]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static void printCorpusCsv(std::ostream& out, const std::vector<CorpusResult>& results) {
+    out << std::setprecision(9) << "corpus,bytes,compressed_bytes,ratio,phase,seconds,mb_per_s,ns_per_byte\n";
+    for (const CorpusResult& r : results) {
+        for (const PhaseTime& p : r.phases) {
+            out << r.name << ',' << r.bytes << ',' << r.fileBytes << ',' << ratioOf(r) << ',' << p.phase << ','
+                << p.seconds << ',' << mbPerSecond(r, p) << ',' << nsPerByte(r, p) << '\n';
+        }
+    }
+}
+
+static CorpusOptions parseCorpusOptions(int argc, char* argv[]) {
+    CorpusOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) { return arg.substr(std::strlen(prefix)); };
+
+        if (arg.rfind("--size=", 0) == 0) {
+            options.sizeMb = std::stoul(value("--size="));
+        } else if (arg.rfind("--dir=", 0) == 0) {
+            options.dir = value("--dir=");
+        } else if (arg.rfind("--repeat=", 0) == 0) {
+            options.repeat = std::max(1, std::stoi(value("--repeat=")));
+        } else if (arg.rfind("--format=", 0) == 0) {
+            options.format = value("--format=");
+            if (options.format != "text" && options.format != "json" && options.format != "csv") {
+                throw std::runtime_error("Nieznany format wynikow: " + options.format);
+            }
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.output = value("--output=");
+        } else {
+            throw std::runtime_error("Nieznana opcja: " + arg);
+        }
+    }
+    return options;
+}
+
+static int runCorpus(int argc, char* argv[]) {
+    CorpusOptions options = parseCorpusOptions(argc, argv);
+
+    // Zestaw plików: wszystkie zwykłe pliki z katalogu albo dane syntetyczne.
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> corpus;
+    if (!options.dir.empty()) {
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(options.dir)) {
+            if (entry.is_regular_file()) files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        for (const fs::path& file : files) {
+            std::vector<uint8_t> data = readBinaryFile(file.string());
+            if (data.empty()) continue;
+            corpus.emplace_back(file.filename().string(), std::move(data));
+        }
+    } else {
+        size_t size = options.sizeMb * 1024 * 1024;
+        std::mt19937 rng(12345);
+        auto bytesOf = [](const std::string& text) { return std::vector<uint8_t>(text.begin(), text.end()); };
+        corpus.emplace_back("losowy", bytesOf(makeRandom(size, rng)));
+        corpus.emplace_back("skewed", bytesOf(makeSkewed(size, rng)));
+        corpus.emplace_back("tekst", bytesOf(makeText(size, rng)));
+        corpus.emplace_back("binarny", bytesOf(makeBinary(size, rng)));
+        corpus.emplace_back("jeden-symbol", std::vector<uint8_t>(size, 'a'));
+    }
+    if (corpus.empty()) throw std::runtime_error("Brak plikow do pomiaru");
+
+    fs::path dir = fs::temp_directory_path() / "huffman-bench-corpus";
+    fs::create_directories(dir);
+
+    std::vector<CorpusResult> results;
+    for (const auto& [name, data] : corpus) {
+        results.push_back(measureCorpus(name, data, options.repeat, dir));
+    }
+    fs::remove_all(dir);
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) throw std::runtime_error("Nie mozna zapisac pliku: " + options.output);
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    if (options.format == "json") {
+        printCorpusJson(out, results, options);
+    } else if (options.format == "csv") {
+        printCorpusCsv(out, results);
+    } else {
+        printCorpusText(out, results);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc > 1 && std::string(argv[1]) == "corpus") return runCorpus(argc, argv);
+
+        size_t sizeMb = argc > 1 ? std::stoul(argv[1]) : 8;
+        size_t size = sizeMb * 1024 * 1024;
+
+        fs::path dir = fs::temp_directory_path() / "huffman-bench";
+        fs::create_directories(dir);
+
+        std::mt19937 rng(12345);
+        runCase("tekst",   makeText(size, rng),   dir);
+        runCase("skewed",  makeSkewed(size, rng), dir);
+        runCase("losowy",  makeRandom(size, rng), dir);
+
+        for (int symbols : {2, 4, 8, 16, 64, 256}) runTreeCase(symbols, rng);
+        runHeapCase(rng);
+
+        fs::remove_all(dir);
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Blad: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef BITIO_H
+#define BITIO_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+  Zapis strumienia bitów od MSB (ten sam układ, który czyta BitReader).
+
+  Bity zbieramy w 64-bitowym rejestrze wyrównanym do lewej, a flush()
+  zapisuje od razu całe 8 bajtów i przesuwa wskaźnik o liczbę pełnych
+  bajtów. Dzięki temu nie ma pętli po pojedynczych bitach ani push_back.
+  - po flush() w rejestrze zostaje <= 7 bitów, więc przed kolejnym flush()
+    można dopisać do 56 bitów (np. 3 kody po 15 bitów),
+  - bufor wyjściowy musi mieć 8 bajtów zapasu za końcem danych.
+*/
+class BitWriter {
+private:
+    uint8_t* out;    // miejsce zapisu następnego pełnego bajtu
+    uint64_t buffer; // bity wyrównane do lewej
+    int count;       // liczba bitów w buffer
+
+    static void storeBigEndian64(uint8_t* p, uint64_t v) {
+        for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (56 - 8 * i));
+    }
+
+public:
+    explicit BitWriter(uint8_t* out) : out(out), buffer(0), count(0) {}
+
+    // Dopisuje kod o długości length (1..56 - bity w rejestrze).
+    void put(uint32_t code, int length) {
+        buffer |= static_cast<uint64_t>(code) << (64 - count - length);
+        count += length;
+    }
+
+    // Zapisuje wszystkie pełne bajty z rejestru.
+    void flush() {
+        storeBigEndian64(out, buffer);
+        int bytes = count >> 3;
+        out += bytes;
+        buffer <<= bytes * 8;
+        count &= 7;
+    }
+
+    // Liczba zapisanych bitów, licząc od początku bufora 'begin'.
+    [[nodiscard]] uint64_t bitsSince(const uint8_t* begin) const {
+        return static_cast<uint64_t>(out - begin) * 8 + count;
+    }
+
+    /*
+      Zapis strumieniowy: po flush() pełne bajty [begin, out) można już oddać,
+      a niepełny bajt zostaje w rejestrze. rewind() zaczyna bufor od nowa
+      i zwraca liczbę pełnych bajtów do zapisania.
+    */
+    size_t rewind(uint8_t* begin) {
+        size_t bytes = static_cast<size_t>(out - begin);
+        out = begin;
+        return bytes;
+    }
+
+    // Zapisuje resztę (ostatni bajt dopełniony zerami) i zwraca koniec danych.
+    uint8_t* finish() {
+        flush();
+        if (count > 0) {
+            out++;
+            buffer = 0;
+            count = 0;
+        }
+        return out;
+    }
+};
+
+/*
+  Odczyt strumienia bitów zapisanego od MSB (tak jak pakuje je compressFile).
+
+  Bity trzymamy w 64-bitowym rejestrze 'buffer' wyrównane do lewej:
+  - 'count' = ile bitów na górze rejestru jest ważnych,
+  - refill() dokłada całe bajty tak, aby było ich co najmniej 56,
+  - peek(n) podgląda n najbliższych bitów, consume(n) je zużywa.
+
+  Za końcem danych czytamy zera (tak jak padding ostatniego bajtu),
+  więc to wywołujący pilnuje, ile bitów jest naprawdę ważnych.
+*/
+class BitReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos;      // indeks następnego bajtu do załadowania
+    uint64_t buffer; // bity wyrównane do lewej (MSB = najbliższy bit)
+    int count;       // liczba ważnych bitów w buffer
+
+    static uint64_t loadBigEndian64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+        return v;
+    }
+
+public:
+    BitReader() : BitReader(nullptr, 0) {}
+    BitReader(const uint8_t* data, size_t size)
+        : data(data), size(size), pos(0), buffer(0), count(0) {}
+
+    // Uzupełnia rejestr do co najmniej 56 ważnych bitów.
+    void refill() {
+        if (pos + 8 <= size) {
+            // Szybka ścieżka: jedno 8-bajtowe wczytanie zamiast pętli po bajtach.
+            buffer |= loadBigEndian64(data + pos) >> count;
+            pos += (63 - count) >> 3;
+            count |= 56;
+        } else {
+            while (count <= 56) {
+                uint64_t byte = pos < size ? data[pos] : 0;
+                buffer |= byte << (56 - count);
+                pos++;
+                count += 8;
+            }
+        }
+    }
+
+    // Zwraca n najbliższych bitów (1 <= n <= 32) bez ich zużywania.
+    [[nodiscard]] uint32_t peek(int n) const {
+        return static_cast<uint32_t>(buffer >> (64 - n));
+    }
+
+    void consume(int n) {
+        buffer <<= n;
+        count -= n;
+    }
+
+    // Ile bitów od początku danych zostało już zużytych.
+    [[nodiscard]] uint64_t bitsConsumed() const {
+        return static_cast<uint64_t>(pos) * 8 - count;
+    }
+};
+
+#endif
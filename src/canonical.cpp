@@ -0,0 +1,50 @@
+#include "canonical.h"
+
+#include <stdexcept>
+
+/*
+    Klasyczny algorytm (jak w DEFLATE):
+    - zliczamy, ile kodów ma każdą długość,
+    - pierwszy kod długości L = (pierwszy kod długości L-1 + ich liczba) << 1,
+    - w obrębie jednej długości kody rosną razem z numerem symbolu.
+*/
+std::vector<CodeWord> assignCanonicalCodes(const CodeLengths& lengths) {
+    std::vector<CodeWord> codes;
+    assignCanonicalCodes(lengths, codes);
+    return codes;
+}
+
+void assignCanonicalCodes(const CodeLengths& lengths, std::vector<CodeWord>& codes) {
+    assignCanonicalCodes(lengths.data(), lengths.size(), codes);
+}
+
+void assignCanonicalCodes(const uint8_t* lengths, size_t symbols, std::vector<CodeWord>& codes) {
+    constexpr int MAX_LEN = 64;
+
+    uint32_t countPerLength[MAX_LEN + 1] = {};
+    for (size_t s = 0; s < symbols; ++s) {
+        if (lengths[s] > MAX_LEN) throw std::runtime_error("Niepoprawna dlugosc kodu");
+        countPerLength[lengths[s]]++;
+    }
+    countPerLength[0] = 0;
+
+    uint64_t nextCode[MAX_LEN + 1] = {};
+    uint64_t code = 0;
+    for (int len = 1; len <= MAX_LEN; ++len) {
+        code = (code + countPerLength[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    codes.clear();
+    for (size_t s = 0; s < symbols; ++s) {
+        int len = lengths[s];
+        if (len == 0) continue;
+
+        // Kod nie mieści się na 'len' bitach -> długości nie tworzą kodu prefiksowego.
+        if (len < MAX_LEN && (nextCode[len] >> len) != 0) {
+            throw std::runtime_error("Niepoprawne dlugosci kodow (nierownosc Krafta)");
+        }
+
+        codes.push_back(CodeWord{nextCode[len]++, static_cast<uint8_t>(len), static_cast<uint16_t>(s)});
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rozmiar alfabetu (symbol = bajt).
+constexpr int ALPHABET_SIZE = 256;
+
+// Alfabet symboli 16-bitowych (symbol = para bajtów, --symbol-bits=16).
+constexpr int WIDE_ALPHABET_SIZE = 65536;
+
+// Górny limit długości kodu: cały kod mieści się w 64-bitowym rejestrze kodera/dekodera.
+constexpr int MAX_CODE_LENGTH = 24;
+
+// Domyślny limit (jak w DEFLATE): tablica dekodująca ma najwyżej dwa poziomy.
+constexpr int DEFAULT_MAX_CODE_LENGTH = 15;
+
+// Długość kodu każdego symbolu (0 = symbol nie występuje).
+using CodeLengths = std::array<uint8_t, ALPHABET_SIZE>;
+
+// To samo dla par bajtów: WIDE_ALPHABET_SIZE pozycji (za duże na stos, więc w wektorze).
+using WideCodeLengths = std::vector<uint8_t>;
+
+// Tryb order-1: numer tablicy kodów dla każdego kontekstu (poprzedniego bajtu).
+using ContextMap = std::array<uint8_t, ALPHABET_SIZE>;
+
+/*
+  Słowo kodowe w postaci liczbowej: 'length' najmłodszych bitów 'code'
+  (pierwszy bit kodu = najstarszy z nich).
+*/
+struct CodeWord {
+    uint64_t code;
+    uint8_t length;
+    uint16_t symbol;
+};
+
+/*
+  Kody kanoniczne: znając same długości, nadajemy kody po kolei
+  w porządku (długość, symbol). Koder i dekoder liczą je identycznie,
+  więc w pliku wystarczy zapisać długości.
+  Zwraca słowa kodowe tylko dla symboli o długości > 0.
+*/
+std::vector<CodeWord> assignCanonicalCodes(const CodeLengths& lengths);
+
+// To samo do istniejącego wektora (jego pamięć jest używana ponownie).
+void assignCanonicalCodes(const CodeLengths& lengths, std::vector<CodeWord>& codes);
+
+// Dowolny alfabet: lengths[0..symbols-1] (np. WideCodeLengths).
+void assignCanonicalCodes(const uint8_t* lengths, size_t symbols, std::vector<CodeWord>& codes);
+
+#endif
@@ -0,0 +1,122 @@
+#include "context.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// Tyle najczęstszych kontekstów grupujemy osobno; rzadsze od razu tworzą jedną wspólną grupę.
+static constexpr size_t CANDIDATE_CONTEXTS = 32;
+
+// Przybliżony koszt tablicy kodów w nagłówku bloku (pary symbol/długość albo serie).
+static constexpr double TABLE_BITS_PER_SYMBOL = 16.0;
+static constexpr double MAX_TABLE_BITS = 8.0 * (ALPHABET_SIZE + 1);
+
+/*
+    Szacowany koszt grupy w bitach: entropia danych (sum c * log2(total / c))
+    + miejsce na tablicę kodów w nagłówku.
+*/
+static double clusterCost(const Histogram& hist) {
+    uint64_t total = 0;
+    double sum = 0.0;
+    int used = 0;
+    for (uint64_t f : hist) {
+        if (f == 0) continue;
+        total += f;
+        sum += static_cast<double>(f) * std::log2(static_cast<double>(f));
+        used++;
+    }
+    if (total == 0) return 0.0;
+
+    double data = static_cast<double>(total) * std::log2(static_cast<double>(total)) - sum;
+    return data + std::min(TABLE_BITS_PER_SYMBOL * used, MAX_TABLE_BITS);
+}
+
+static Histogram merged(const Histogram& a, const Histogram& b) {
+    Histogram sum;
+    for (int c = 0; c < ALPHABET_SIZE; ++c) sum[c] = a[c] + b[c];
+    return sum;
+}
+
+ContextClusters clusterContexts(const std::vector<Histogram>& contexts, size_t maxTables) {
+    /* 1) Konteksty, które wystąpiły, od najczęstszego */
+    std::vector<uint64_t> totals(contexts.size());
+    std::vector<size_t> order;
+    for (size_t ctx = 0; ctx < contexts.size(); ++ctx) {
+        totals[ctx] = std::accumulate(contexts[ctx].begin(), contexts[ctx].end(), uint64_t(0));
+        if (totals[ctx] > 0) order.push_back(ctx);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return totals[a] > totals[b]; });
+
+    /* 2) Grupy początkowe: po jednej na częsty kontekst + wspólna dla reszty */
+    std::vector<Histogram> hists;
+    std::vector<size_t> owner(contexts.size(), 0);
+    for (size_t k = 0; k < order.size(); ++k) {
+        size_t ctx = order[k];
+        if (k < CANDIDATE_CONTEXTS) {
+            owner[ctx] = hists.size();
+            hists.push_back(contexts[ctx]);
+        } else {
+            if (k == CANDIDATE_CONTEXTS) hists.push_back(Histogram{});
+            owner[ctx] = CANDIDATE_CONTEXTS;
+            hists.back() = merged(hists.back(), contexts[ctx]);
+        }
+    }
+
+    /* 3) Koszt każdej grupy i zmiana kosztu po połączeniu każdej pary */
+    const size_t n = hists.size();
+    std::vector<double> cost(n);
+    std::vector<bool> active(n, true);
+    std::vector<double> delta(n * n, 0.0);
+    for (size_t a = 0; a < n; ++a) cost[a] = clusterCost(hists[a]);
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = a + 1; b < n; ++b) {
+            delta[a * n + b] = clusterCost(merged(hists[a], hists[b])) - cost[a] - cost[b];
+        }
+    }
+
+    /* 4) Łączenie najtańszej pary, dopóki grup jest za dużo albo łączenie zmniejsza koszt */
+    size_t remaining = n;
+    while (remaining > 1) {
+        size_t bestA = 0, bestB = 0;
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t a = 0; a < n; ++a) {
+            if (!active[a]) continue;
+            for (size_t b = a + 1; b < n; ++b) {
+                if (active[b] && delta[a * n + b] < best) {
+                    best = delta[a * n + b];
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+        if (remaining <= maxTables && best >= 0.0) break;
+
+        hists[bestA] = merged(hists[bestA], hists[bestB]);
+        cost[bestA] = clusterCost(hists[bestA]);
+        active[bestB] = false;
+        remaining--;
+        for (size_t& o : owner) {
+            if (o == bestB) o = bestA;
+        }
+
+        for (size_t other = 0; other < n; ++other) {
+            if (!active[other] || other == bestA) continue;
+            size_t a = std::min(bestA, other), b = std::max(bestA, other);
+            delta[a * n + b] = clusterCost(merged(hists[a], hists[b])) - cost[a] - cost[b];
+        }
+    }
+
+    /* 5) Numery grup po kolei; konteksty, które nie wystąpiły, dostają grupę 0 */
+    ContextClusters result;
+    std::vector<size_t> number(n, 0);
+    for (size_t g = 0; g < n; ++g) {
+        if (!active[g]) continue;
+        number[g] = result.histograms.size();
+        result.histograms.push_back(hists[g]);
+    }
+    for (size_t ctx = 0; ctx < contexts.size(); ++ctx) {
+        result.map[ctx] = totals[ctx] > 0 ? static_cast<uint8_t>(number[owner[ctx]]) : 0;
+    }
+    return result;
+}
@@ -0,0 +1,26 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "canonical.h"
+#include "histogram.h"
+
+#include <cstddef>
+#include <vector>
+
+/*
+  Model order-1: kod bajtu zależy od bajtu poprzedniego (kontekstu).
+
+  Osobna tablica kodów dla każdego z 256 kontekstów zajęłaby w nagłówku bloku
+  więcej, niż zyskuje, więc konteksty o podobnych rozkładach łączymy w grupy
+  ze wspólną tablicą. Łączymy zachłannie parę, której połączenie najmniej
+  zwiększa szacowany koszt (entropia danych + nagłówek tablicy), dopóki grup
+  jest więcej niż maxTables albo połączenie się opłaca.
+*/
+struct ContextClusters {
+    ContextMap map{};                  // kontekst -> numer grupy (tablicy kodów)
+    std::vector<Histogram> histograms; // częstotliwości zsumowane w każdej grupie
+};
+
+ContextClusters clusterContexts(const std::vector<Histogram>& contexts, size_t maxTables);
+
+#endif
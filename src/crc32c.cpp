@@ -0,0 +1,145 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define HUFFMAN_HAVE_CRC32C_SSE42 1
+#endif
+
+// Wielomian w zapisie odwróconym (najmłodszy bit = najwyższa potęga x).
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78u;
+
+/*
+    Mnożenie a * b modulo wielomian (obie liczby w zapisie odwróconym: bit 31 = x^0).
+    Z niego wynika przesunięcie sumy o n bajtów zer – podstawa łączenia sum fragmentów.
+*/
+static uint32_t multiplyModPoly(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t bit = 1u << 31; bit != 0; bit >>= 1) {
+        if (a & bit) product ^= b;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return product;
+}
+
+// x^(8 * n) modulo wielomian: kolejne kwadraty x^(2^k), jak w zlib (crc32_combine).
+static uint32_t shiftBytes(uint64_t n) {
+    uint32_t power = 1u << 30; // x^1
+    for (int k = 0; k < 3; ++k) power = multiplyModPoly(power, power); // x^8
+    uint32_t result = 1u << 31; // x^0
+    for (; n != 0; n >>= 1) {
+        if (n & 1) result = multiplyModPoly(power, result);
+        power = multiplyModPoly(power, power);
+    }
+    return result;
+}
+
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB) {
+    return multiplyModPoly(shiftBytes(sizeB), crcA) ^ crcB;
+}
+
+/* Wersja programowa: slicing-by-8 (8 tablic po 256 pozycji, jeden odczyt 8 bajtów naraz). */
+
+using SliceTables = std::array<std::array<uint32_t, 256>, 8>;
+
+static SliceTables makeSliceTables() {
+    SliceTables tables{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; ++k) crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        tables[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+        for (int t = 1; t < 8; ++t) tables[t][n] = (tables[t - 1][n] >> 8) ^ tables[0][tables[t - 1][n] & 0xFF];
+    }
+    return tables;
+}
+
+static const SliceTables SLICE_TABLES = makeSliceTables();
+
+// 8 bajtów jako liczba little-endian (tablice zakładają, że pierwszy bajt to najmłodszy).
+static uint64_t load64(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+#else
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; --k) v = (v << 8) | p[k];
+    return v;
+#endif
+}
+
+uint32_t crc32cSoftware(const uint8_t* data, size_t size, uint32_t crc) {
+    const SliceTables& t = SLICE_TABLES;
+    uint32_t c = ~crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint64_t v = load64(data) ^ c;
+        c = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][(v >> 24) & 0xFF] ^
+            t[3][(v >> 32) & 0xFF] ^ t[2][(v >> 40) & 0xFF] ^ t[1][(v >> 48) & 0xFF] ^ t[0][v >> 56];
+    }
+    for (; size > 0; ++data, --size) c = (c >> 8) ^ t[0][(c ^ *data) & 0xFF];
+    return ~c;
+}
+
+#ifdef HUFFMAN_HAVE_CRC32C_SSE42
+
+/*
+    Instrukcja crc32 ma opóźnienie 3 cykli, więc jeden łańcuch wykorzystuje 1/3 jej
+    przepustowości. Dzielimy więc dane na trzy sąsiednie fragmenty po LANE bajtów,
+    liczymy trzy niezależne sumy i sklejamy je przesunięciem o LANE bajtów.
+*/
+static constexpr size_t LANE = 8192;
+static constexpr size_t SHORT_LANE = 256;
+
+static const uint32_t LANE_SHIFT = shiftBytes(LANE);
+static const uint32_t SHORT_LANE_SHIFT = shiftBytes(SHORT_LANE);
+
+__attribute__((target("sse4.2"))) static uint32_t crc32cLanes(uint64_t& c, const uint8_t*& data, size_t& size,
+                                                               size_t lane, uint32_t shift) {
+    for (; size >= 3 * lane; data += 3 * lane, size -= 3 * lane) {
+        uint64_t c0 = c, c1 = 0, c2 = 0;
+        for (size_t i = 0; i < lane; i += 8) {
+            c0 = _mm_crc32_u64(c0, load64(data + i));
+            c1 = _mm_crc32_u64(c1, load64(data + lane + i));
+            c2 = _mm_crc32_u64(c2, load64(data + 2 * lane + i));
+        }
+        c = multiplyModPoly(shift, static_cast<uint32_t>(c0)) ^ static_cast<uint32_t>(c1);
+        c = multiplyModPoly(shift, static_cast<uint32_t>(c)) ^ static_cast<uint32_t>(c2);
+    }
+    return static_cast<uint32_t>(c);
+}
+
+__attribute__((target("sse4.2"))) static uint32_t crc32cSse42(const uint8_t* data, size_t size, uint32_t crc) {
+    uint64_t c = static_cast<uint32_t>(~crc);
+    crc32cLanes(c, data, size, LANE, LANE_SHIFT);
+    crc32cLanes(c, data, size, SHORT_LANE, SHORT_LANE_SHIFT);
+    for (; size >= 8; data += 8, size -= 8) c = _mm_crc32_u64(c, load64(data));
+    uint32_t c32 = static_cast<uint32_t>(c);
+    for (; size > 0; ++data, --size) c32 = _mm_crc32_u8(c32, *data);
+    return ~c32;
+}
+
+static const bool HAS_SSE42 = __builtin_cpu_supports("sse4.2");
+
+bool crc32cHardware() {
+    return HAS_SSE42;
+}
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc) {
+    return HAS_SSE42 ? crc32cSse42(data, size, crc) : crc32cSoftware(data, size, crc);
+}
+
+#else
+
+bool crc32cHardware() {
+    return false;
+}
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc) {
+    return crc32cSoftware(data, size, crc);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+  CRC32C (Castagnoli, wielomian 0x1EDC6F41 – ten sam co w iSCSI, ext4 i Snappy)
+  do sum kontrolnych bloków i całych danych.
+
+  Na x86-64 z SSE4.2 liczymy instrukcją crc32 (wybór w czasie działania, więc ten sam
+  program działa też na starszych procesorach): trzy strumienie naraz, bo instrukcja ma
+  opóźnienie 3 cykli, a przepustowość 1 na cykl. W pozostałych przypadkach – programowo,
+  tablicami po 8 bajtów (slicing-by-8).
+*/
+
+// CRC32C danych, kontynuując wcześniejszą sumę 'crc' (0 = od początku).
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// To samo zawsze programowo (do porównań w benchmarku i testów).
+uint32_t crc32cSoftware(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// Czy crc32c korzysta z instrukcji procesora.
+bool crc32cHardware();
+
+/*
+  CRC32C sklejenia A + B z sum crcA i crcB oraz długości B (bez czytania danych) –
+  suma całego pliku z sum bloków liczonych niezależnie na różnych wątkach.
+*/
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+#endif
@@ -0,0 +1,446 @@
+#include "decoder.h"
+#include "bitio.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+DecodeTable DecodeTable::fromDictionary(const std::unordered_map<std::string, char>& reverseDict) {
+    std::vector<CodeWord> codes;
+    codes.reserve(reverseDict.size());
+
+    for (const auto& [bits, ch] : reverseDict) {
+        if (bits.empty() || bits.size() > 64) {
+            throw std::runtime_error("Uszkodzony plik: nieobslugiwana dlugosc kodu");
+        }
+
+        CodeWord cw{0, static_cast<uint8_t>(bits.size()), static_cast<uint8_t>(ch)};
+        for (char b : bits) {
+            if (b != '0' && b != '1') throw std::runtime_error("Uszkodzony plik: blad slownika");
+            cw.code = (cw.code << 1) | (b == '1' ? 1 : 0);
+        }
+        codes.push_back(cw);
+    }
+
+    return fromCodeWords(std::move(codes));
+}
+
+DecodeTable DecodeTable::fromCodeLengths(const CodeLengths& lengths) {
+    DecodeTable table;
+    table.assign(lengths);
+    return table;
+}
+
+void DecodeTable::assign(const CodeLengths& lengths) {
+    thread_local std::vector<CodeWord> codes;
+    assignCanonicalCodes(lengths, codes);
+    build(codes);
+}
+
+void DecodeTable::assign(const WideCodeLengths& lengths) {
+    thread_local std::vector<CodeWord> codes;
+    assignCanonicalCodes(lengths.data(), lengths.size(), codes);
+    build(codes);
+}
+
+DecodeTable DecodeTable::fromCodeWords(std::vector<CodeWord> codes) {
+    DecodeTable table;
+    table.build(codes);
+    return table;
+}
+
+/*
+    Kody sortujemy po wartości wyrównanej do lewej – wtedy kody o wspólnym
+    prefiksie leżą obok siebie i każdą podtablicę budujemy z ciągłego zakresu.
+*/
+void DecodeTable::build(std::vector<CodeWord>& codes) {
+    entries.clear();
+    rootBits = 0;
+    maxLength = 0;
+    if (codes.empty()) return;
+
+    std::sort(codes.begin(), codes.end(), [](const CodeWord& a, const CodeWord& b) {
+        uint64_t aa = a.code << (64 - a.length);
+        uint64_t bb = b.code << (64 - b.length);
+        if (aa != bb) return aa < bb;
+        return a.length < b.length;
+    });
+
+    for (const CodeWord& cw : codes) {
+        if (cw.length == 0 || cw.length > 64) throw std::runtime_error("Niepoprawna dlugosc kodu");
+        maxLength = std::max(maxLength, static_cast<int>(cw.length));
+    }
+
+    buildLevel(codes, 0, codes.size(), 0, rootBits);
+}
+
+/*
+    Buduje jedną tablicę dla kodów [first, last), które mają wspólne
+    pierwsze 'consumed' bitów. Zwraca indeks początku tablicy i jej szerokość.
+    - kod mieszczący się w tablicy: wypełniamy wszystkie pozycje z jego prefiksem,
+    - kod dłuższy: pozycja wskazuje na podtablicę zbudowaną rekurencyjnie.
+*/
+uint32_t DecodeTable::buildLevel(const std::vector<CodeWord>& codes, size_t first, size_t last,
+                                 int consumed, int& width) {
+    int longest = 0;
+    for (size_t i = first; i < last; ++i) {
+        longest = std::max(longest, static_cast<int>(codes[i].length));
+    }
+
+    width = std::min(consumed == 0 ? ROOT_BITS : SUB_BITS, longest - consumed);
+    uint32_t base = static_cast<uint32_t>(entries.size());
+    entries.resize(entries.size() + (size_t(1) << width), DecodeEntry{0, 0, DECODE_INVALID});
+
+    auto indexOf = [&](const CodeWord& cw) {
+        uint64_t aligned = cw.code << (64 - cw.length);
+        return static_cast<uint32_t>((aligned << consumed) >> (64 - width));
+    };
+
+    size_t i = first;
+    while (i < last) {
+        const CodeWord& cw = codes[i];
+        uint32_t index = indexOf(cw);
+        int rest = cw.length - consumed;
+
+        if (rest <= width) {
+            uint32_t span = 1u << (width - rest);
+            for (uint32_t k = 0; k < span; ++k) {
+                DecodeEntry& e = entries[base + index + k];
+                if (e.kind != DECODE_INVALID) {
+                    throw std::runtime_error("Uszkodzony plik: slownik nie jest kodem prefiksowym");
+                }
+                e = DecodeEntry{cw.symbol, static_cast<uint8_t>(rest), DECODE_SYMBOL};
+            }
+            ++i;
+            continue;
+        }
+
+        size_t j = i + 1;
+        while (j < last && indexOf(codes[j]) == index) ++j;
+
+        if (entries[base + index].kind != DECODE_INVALID) {
+            throw std::runtime_error("Uszkodzony plik: slownik nie jest kodem prefiksowym");
+        }
+
+        int subWidth = 0;
+        uint32_t sub = buildLevel(codes, i, j, consumed + width, subWidth);
+        entries[base + index] = DecodeEntry{sub, static_cast<uint8_t>(subWidth), DECODE_LINK};
+        i = j;
+    }
+
+    return base;
+}
+
+/*
+    Dekodowanie jednego symbolu: odczyt z tablicy głównej, a dla długich kodów
+    przejście do podtablic (każdy poziom zużywa swoją szerokość bitów).
+    Wymaga, by w rejestrze było co najmniej tyle bitów, ile ma najdłuższy kod.
+*/
+static inline uint32_t decodeSymbol(const DecodeEntry* table, int rootBits, BitReader& reader) {
+    int width = rootBits;
+    DecodeEntry e = table[reader.peek(width)];
+
+    while (e.kind == DECODE_LINK) {
+        reader.consume(width);
+        reader.refill();
+        width = e.bits;
+        e = table[e.value + reader.peek(width)];
+    }
+
+    if (e.kind != DECODE_SYMBOL) {
+        throw std::runtime_error("Uszkodzony plik: niepoprawny kod w danych");
+    }
+
+    reader.consume(e.bits);
+    return e.value;
+}
+
+/*
+    Dekodowanie strumienia o nieznanej liczbie symboli (format jednostrumieniowy):
+    - po każdym refill() w rejestrze jest >= 56 bitów, więc gdy najdłuższy kod
+      ma maxLength bitów, możemy zdekodować 56 / maxLength znaków bez kolejnego refill(),
+    - dopóki do końca zostaje dużo bitów, nie sprawdzamy końca strumienia dla każdego znaku,
+    - końcówkę dekodujemy ostrożnie: kod nie może wyjść poza bitCount.
+*/
+void DecodeTable::decode(const uint8_t* data, size_t byteCount, uint64_t bitCount, std::string& out) const {
+    if (bitCount == 0) return;
+    if (entries.empty()) throw std::runtime_error("Uszkodzony plik: brak slownika");
+    if ((bitCount + 7) / 8 > byteCount) throw std::runtime_error("Uszkodzony plik: za malo danych");
+
+    BitReader reader(data, byteCount);
+    const DecodeEntry* table = entries.data();
+    const int perRefill = std::max(1, 56 / maxLength);
+    const uint64_t fastLimit = static_cast<uint64_t>(perRefill) * maxLength;
+
+    out.reserve(out.size() + bitCount / maxLength);
+
+    while (bitCount - reader.bitsConsumed() >= fastLimit) {
+        reader.refill();
+        for (int k = 0; k < perRefill; ++k) {
+            out.push_back(static_cast<char>(decodeSymbol(table, rootBits, reader)));
+        }
+    }
+
+    while (reader.bitsConsumed() < bitCount) {
+        reader.refill();
+        out.push_back(static_cast<char>(decodeSymbol(table, rootBits, reader)));
+    }
+
+    // Ostatni kod "wystaje" poza bitCount -> plik jest niekompletny.
+    if (reader.bitsConsumed() != bitCount) {
+        throw std::runtime_error("Niepelne dane – nie mozna w pelni zdekodowac pliku");
+    }
+}
+
+/*
+    Zapis i-tego symbolu do bufora: Symbol = uint8_t – jeden bajt, uint16_t – para
+    bajtów (młodszy pierwszy, jak przy liczeniu histogramu par).
+*/
+template <typename Symbol>
+static inline void storeSymbol(uint8_t* out, size_t i, uint32_t value) {
+    if constexpr (sizeof(Symbol) == 1) {
+        out[i] = static_cast<uint8_t>(value);
+    } else {
+        out[2 * i] = static_cast<uint8_t>(value);
+        out[2 * i + 1] = static_cast<uint8_t>(value >> 8);
+    }
+}
+
+/*
+    Dokończenie strumienia o znanej liczbie symboli od pozycji i: pełne serie
+    perRefill symboli na jeden refill(), potem pojedyncze symbole. Na końcu
+    liczba zużytych bitów musi się zgadzać z bitCount.
+*/
+template <typename Symbol>
+static void decodeRemaining(const DecodeEntry* table, int rootBits, size_t perRefill, BitReader& reader,
+                            uint64_t bitCount, uint8_t* out, size_t i, size_t count) {
+    while (count - i >= perRefill) {
+        reader.refill();
+        for (size_t k = 0; k < perRefill; ++k, ++i) {
+            storeSymbol<Symbol>(out, i, decodeSymbol(table, rootBits, reader));
+        }
+    }
+
+    for (; i < count; ++i) {
+        reader.refill();
+        storeSymbol<Symbol>(out, i, decodeSymbol(table, rootBits, reader));
+    }
+
+    if (reader.bitsConsumed() != bitCount) {
+        throw std::runtime_error("Niepelne dane – nie mozna w pelni zdekodowac pliku");
+    }
+}
+
+void DecodeTable::checkStream(const Stream& stream) const {
+    if (stream.count == 0 && stream.bitCount != 0) {
+        throw std::runtime_error("Uszkodzony plik: nadmiarowe dane bloku");
+    }
+    if (stream.count > 0 && entries.empty()) throw std::runtime_error("Uszkodzony plik: brak slownika");
+    if ((stream.bitCount + 7) / 8 > stream.byteCount) {
+        throw std::runtime_error("Uszkodzony plik: za malo danych");
+    }
+}
+
+/*
+    Dekodowanie bloku o znanej liczbie symboli: piszemy prosto do bufora wyjściowego
+    i nie sprawdzamy końca strumienia w pętli. Czytanie za końcem danych daje zera,
+    więc uszkodzony strumień nie wyjdzie poza bufor – wykryje go końcowe
+    porównanie liczby zużytych bitów z bitCount.
+*/
+void DecodeTable::decode(const uint8_t* data, size_t byteCount, uint64_t bitCount,
+                         uint8_t* out, size_t count) const {
+    checkStream(Stream{data, byteCount, bitCount, out, count});
+    if (count == 0) return;
+
+    BitReader reader(data, byteCount);
+    const size_t perRefill = static_cast<size_t>(std::max(1, 56 / maxLength));
+    decodeRemaining<uint8_t>(entries.data(), rootBits, perRefill, reader, bitCount, out, 0, count);
+}
+
+/*
+    Dekodowanie kilku strumieni naraz. W jednym strumieniu każdy symbol czeka
+    na poprzedni (dopiero po nim wiadomo, od którego bitu zaczyna się kolejny kod),
+    więc procesor wykonuje odczyty z tablicy jeden po drugim. Symbole z różnych
+    strumieni są od siebie niezależne – przeplatając je, dajemy procesorowi
+    INTERLEAVE łańcuchów zależności do wykonywania równolegle.
+*/
+template <typename Symbol>
+void DecodeTable::decodeInterleaved(const Stream* streams) const {
+    const DecodeEntry* table = entries.data();
+    const size_t perRefill = static_cast<size_t>(std::max(1, 56 / std::max(1, maxLength)));
+
+    size_t common = streams[0].count;
+    for (size_t s = 0; s < INTERLEAVE; ++s) {
+        checkStream(streams[s]);
+        common = std::min(common, streams[s].count);
+    }
+
+    BitReader readers[INTERLEAVE] = {
+        BitReader(streams[0].data, streams[0].byteCount), BitReader(streams[1].data, streams[1].byteCount),
+        BitReader(streams[2].data, streams[2].byteCount), BitReader(streams[3].data, streams[3].byteCount),
+    };
+    uint8_t* out[INTERLEAVE] = {streams[0].out, streams[1].out, streams[2].out, streams[3].out};
+
+    size_t i = 0;
+    if (maxLength <= rootBits) {
+        /*
+          Wszystkie kody mieszczą się w tablicy głównej: bez podtablic i bez skoku
+          na każdy symbol. Niepoprawna pozycja ma bits = 0 (nic nie zużywa),
+          więc wystarczy zebrać jej wystąpienie i sprawdzić raz po serii.
+        */
+        while (common - i >= perRefill) {
+            uint8_t invalid = 0;
+            for (size_t s = 0; s < INTERLEAVE; ++s) readers[s].refill();
+            for (size_t k = 0; k < perRefill; ++k, ++i) {
+                for (size_t s = 0; s < INTERLEAVE; ++s) {
+                    DecodeEntry e = table[readers[s].peek(rootBits)];
+                    readers[s].consume(e.bits);
+                    invalid |= e.kind ^ DECODE_SYMBOL;
+                    storeSymbol<Symbol>(out[s], i, e.value);
+                }
+            }
+            if (invalid) throw std::runtime_error("Uszkodzony plik: niepoprawny kod w danych");
+        }
+    } else {
+        while (common - i >= perRefill) {
+            for (size_t s = 0; s < INTERLEAVE; ++s) readers[s].refill();
+            for (size_t k = 0; k < perRefill; ++k, ++i) {
+                for (size_t s = 0; s < INTERLEAVE; ++s) {
+                    storeSymbol<Symbol>(out[s], i, decodeSymbol(table, rootBits, readers[s]));
+                }
+            }
+        }
+    }
+
+    // Reszta każdego strumienia (różnej długości) osobno.
+    for (size_t s = 0; s < INTERLEAVE; ++s) {
+        decodeRemaining<Symbol>(table, rootBits, perRefill, readers[s], streams[s].bitCount, out[s], i,
+                                streams[s].count);
+    }
+}
+
+template <typename Symbol>
+void DecodeTable::decodeAll(const Stream* streams, size_t n) const {
+    size_t i = 0;
+    for (; n - i >= INTERLEAVE; i += INTERLEAVE) decodeInterleaved<Symbol>(streams + i);
+    for (; i < n; ++i) {
+        const Stream& stream = streams[i];
+        checkStream(stream);
+        if (stream.count == 0) continue;
+        BitReader reader(stream.data, stream.byteCount);
+        const size_t perRefill = static_cast<size_t>(std::max(1, 56 / maxLength));
+        decodeRemaining<Symbol>(entries.data(), rootBits, perRefill, reader, stream.bitCount, stream.out, 0,
+                                stream.count);
+    }
+}
+
+void DecodeTable::decodeStreams(const Stream* streams, size_t n) const {
+    decodeAll<uint8_t>(streams, n);
+}
+
+void DecodeTable::decodeWideStreams(const Stream* streams, size_t n) const {
+    decodeAll<uint16_t>(streams, n);
+}
+
+// Tablice order-1 rozwinięte na wszystkie konteksty (bez pośredniego odczytu mapy).
+struct ContextTables {
+    const DecodeEntry* entries[ALPHABET_SIZE];
+    int rootBits[ALPHABET_SIZE];
+};
+
+/*
+    Dekodowanie LANES strumieni order-1 naraz. Każdy strumień ma własny kontekst
+    (ostatni zdekodowany symbol), więc łańcuchy zależności się nie przecinają.
+*/
+template <size_t LANES>
+static void decodeContextLanes(const ContextTables& ctx, size_t perRefill, const DecodeTable::Stream* streams) {
+    BitReader readers[LANES];
+    uint32_t prev[LANES] = {};
+    size_t common = streams[0].count;
+    for (size_t s = 0; s < LANES; ++s) {
+        readers[s] = BitReader(streams[s].data, streams[s].byteCount);
+        common = std::min(common, streams[s].count);
+    }
+
+    auto step = [&](size_t s, size_t i) {
+        uint32_t symbol = decodeSymbol(ctx.entries[prev[s]], ctx.rootBits[prev[s]], readers[s]);
+        streams[s].out[i] = static_cast<uint8_t>(symbol);
+        prev[s] = symbol;
+    };
+
+    size_t i = 0;
+    while (common - i >= perRefill) {
+        for (size_t s = 0; s < LANES; ++s) readers[s].refill();
+        for (size_t k = 0; k < perRefill; ++k, ++i) {
+            for (size_t s = 0; s < LANES; ++s) step(s, i);
+        }
+    }
+
+    // Reszta każdego strumienia osobno.
+    for (size_t s = 0; s < LANES; ++s) {
+        size_t j = i;
+        const size_t count = streams[s].count;
+        while (count - j >= perRefill) {
+            readers[s].refill();
+            for (size_t k = 0; k < perRefill; ++k) step(s, j++);
+        }
+        while (j < count) {
+            readers[s].refill();
+            step(s, j++);
+        }
+        if (readers[s].bitsConsumed() != streams[s].bitCount) {
+            throw std::runtime_error("Niepelne dane – nie mozna w pelni zdekodowac pliku");
+        }
+    }
+}
+
+void DecodeTable::decodeStreams(const DecodeTable* tables, size_t tableCount, const ContextMap& map,
+                                const Stream* streams, size_t n) {
+    if (tableCount == 0) throw std::runtime_error("Uszkodzony plik: brak slownika");
+
+    int longest = 0;
+    for (size_t t = 0; t < tableCount; ++t) {
+        const DecodeTable& table = tables[t];
+        if (table.entries.empty()) throw std::runtime_error("Uszkodzony plik: brak slownika");
+        longest = std::max(longest, table.maxLength);
+    }
+    for (size_t i = 0; i < n; ++i) tables[0].checkStream(streams[i]);
+
+    ContextTables ctx;
+    for (int c = 0; c < ALPHABET_SIZE; ++c) {
+        if (map[c] >= tableCount) throw std::runtime_error("Uszkodzony plik: niepoprawne tablice kontekstow");
+        ctx.entries[c] = tables[map[c]].entries.data();
+        ctx.rootBits[c] = tables[map[c]].rootBits;
+    }
+
+    const size_t perRefill = static_cast<size_t>(std::max(1, 56 / longest));
+    size_t i = 0;
+    for (; n - i >= INTERLEAVE; i += INTERLEAVE) decodeContextLanes<INTERLEAVE>(ctx, perRefill, streams + i);
+    for (; i < n; ++i) decodeContextLanes<1>(ctx, perRefill, streams + i);
+}
+
+std::string decodeBitByBit(const CompressedData& cd) {
+    std::string decoded;
+    std::string buffer;
+
+    for (uint32_t i = 0; i < cd.bitCount; ++i) {
+        // Wyciągamy i-ty bit (czytamy od MSB: 7..0).
+        uint8_t byte = cd.data[i / 8];
+        bool bit = (byte >> (7 - (i % 8))) & 1;
+
+        buffer += (bit ? '1' : '0');
+
+        // Ponieważ kody są prefiksowe, gdy buffer pasuje do kodu -> mamy znak.
+        auto it = cd.reverseDict.find(buffer);
+        if (it != cd.reverseDict.end()) {
+            decoded += it->second;
+            buffer.clear();
+        }
+    }
+
+    // Jeśli zostały bity, które nie tworzą żadnego kodu -> plik jest niekompletny.
+    if (!buffer.empty()) {
+        throw std::runtime_error("Niepelne dane – nie mozna w pelni zdekodowac pliku");
+    }
+
+    return decoded;
+}
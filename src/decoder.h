@@ -0,0 +1,107 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include "io.h"
+#include "canonical.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Rodzaj pozycji w tablicy dekodującej.
+enum DecodeKind : uint8_t {
+    DECODE_INVALID = 0, // żaden kod nie zaczyna się od tych bitów
+    DECODE_SYMBOL  = 1, // liść: value = symbol, bits = ile bitów zużyć na tym poziomie
+    DECODE_LINK    = 2  // dłuższe kody: value = początek podtablicy, bits = jej szerokość
+};
+
+struct DecodeEntry {
+    uint32_t value;
+    uint8_t bits;
+    uint8_t kind;
+};
+
+/*
+  Tablicowy dekoder kodów prefiksowych.
+
+  Zamiast dokładać po jednym bicie do bufora i szukać go w słowniku,
+  podglądamy ROOT_BITS bitów naraz i jednym odczytem z tablicy dostajemy
+  znak oraz długość jego kodu. Kody dłuższe niż ROOT_BITS trafiają
+  do podtablic drugiego (i ewentualnie kolejnych) poziomu.
+*/
+class DecodeTable {
+public:
+    static constexpr int ROOT_BITS = 11;
+    static constexpr int SUB_BITS  = 11;
+    static constexpr size_t INTERLEAVE = 4; // ile strumieni decodeStreams dekoduje naraz
+
+    // Niezależny strumień bitów i miejsce na jego count symboli.
+    struct Stream {
+        const uint8_t* data;
+        size_t byteCount;
+        uint64_t bitCount;
+        uint8_t* out;
+        size_t count;
+    };
+
+    DecodeTable() = default;
+
+    // Buduje tablicę ze słownika wczytanego przez readCompressedFile ("010" -> znak).
+    static DecodeTable fromDictionary(const std::unordered_map<std::string, char>& reverseDict);
+
+    // Buduje tablicę z samych długości kodów (format kanoniczny).
+    static DecodeTable fromCodeLengths(const CodeLengths& lengths);
+
+    // Buduje tablicę z listy słów kodowych (kody muszą być prefiksowe).
+    static DecodeTable fromCodeWords(std::vector<CodeWord> codes);
+
+    // To samo co fromCodeLengths, ale w istniejącym obiekcie (pamięć tablicy jest używana ponownie).
+    void assign(const CodeLengths& lengths);
+
+    // Tablica dla par bajtów (symbole 0..65535, --symbol-bits=16).
+    void assign(const WideCodeLengths& lengths);
+
+    // Dekoduje dokładnie bitCount bitów i dopisuje znaki do out.
+    void decode(const uint8_t* data, size_t byteCount, uint64_t bitCount, std::string& out) const;
+
+    // Dekoduje dokładnie count symboli do out i sprawdza, że zużyły bitCount bitów.
+    void decode(const uint8_t* data, size_t byteCount, uint64_t bitCount,
+                uint8_t* out, size_t count) const;
+
+    // Dekoduje n strumieni: po INTERLEAVE naraz, jeden symbol z każdego w kroku pętli.
+    void decodeStreams(const Stream* streams, size_t n) const;
+
+    /*
+      To samo dla tablicy par bajtów: count strumienia to liczba par, a każdy symbol
+      zapisujemy jako dwa bajty (młodszy pierwszy) – jeden odczyt z tablicy daje dwa bajty.
+    */
+    void decodeWideStreams(const Stream* streams, size_t n) const;
+
+    /*
+      Order-1: symbol dekodujemy tablicą tables[map[poprzedni symbol]], a pierwszy
+      symbol strumienia – tablicą kontekstu 0. Strumienie jak w decodeStreams.
+    */
+    static void decodeStreams(const DecodeTable* tables, size_t tableCount, const ContextMap& map,
+                              const Stream* streams, size_t n);
+
+private:
+    std::vector<DecodeEntry> entries; // tablica główna (od 0) + podtablice
+    int rootBits = 0;
+    int maxLength = 0;
+
+    void build(std::vector<CodeWord>& codes);
+    void checkStream(const Stream& stream) const;
+    template <typename Symbol>
+    void decodeInterleaved(const Stream* streams) const;
+    template <typename Symbol>
+    void decodeAll(const Stream* streams, size_t n) const;
+
+    uint32_t buildLevel(const std::vector<CodeWord>& codes, size_t first, size_t last,
+                        int consumed, int& width);
+};
+
+// Referencyjny dekoder bit po bicie (dawna ścieżka decompressFile) – do porównań i benchmarku.
+std::string decodeBitByBit(const CompressedData& cd);
+
+#endif
@@ -0,0 +1,118 @@
+#include "demo.h"
+#include "minheap.h"
+#include "indexedheap.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+/* DEMO KOPCA (MinHeap)
+   - buildFromArray (heapify)
+   - insert
+   - decreaseKey
+   - extractMin w pętli (sortowanie rosnąco po priorytecie)
+*/
+struct DemoItem {
+    std::string name;
+    int priority;
+};
+
+static bool lessDemoItem(const DemoItem& a, const DemoItem& b) {
+    return a.priority < b.priority;
+}
+
+/* DEMO KOPCA Z UCHWYTAMI (IndexedMinHeap)
+   Liczności symboli w przesuwanym oknie: zamiast budować kopiec od nowa po każdym
+   przesunięciu, zmieniamy priorytet tylko dwóch symboli (wchodzącego i wychodzącego)
+   przez ich uchwyty – increaseKey / decreaseKey / erase w O(log n).
+*/
+struct WindowCount {
+    int count;
+    char symbol;
+};
+
+static bool lessWindowCount(const WindowCount& a, const WindowCount& b) {
+    return a.count != b.count ? a.count < b.count : a.symbol < b.symbol;
+}
+
+static void runIndexedHeapDemo() {
+    std::cout << "\n=== INDEXED HEAP DEMO ===\n";
+
+    const std::string text = "abracadabra_alakazam";
+    const size_t window = 6;
+
+    using CountHeap = IndexedMinHeap<WindowCount>;
+    CountHeap heap(lessWindowCount);
+    std::unordered_map<char, CountHeap::Handle> handles;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        // Symbol wchodzi do okna: nowy element albo mniejszy priorytet (większa liczność).
+        char in = text[i];
+        auto it = handles.find(in);
+        if (it == handles.end()) {
+            handles[in] = heap.insert({1, in});
+        } else {
+            WindowCount c = heap.get(it->second);
+            heap.increaseKey(it->second, {c.count + 1, in});
+        }
+
+        // Symbol wypada z okna: większy priorytet albo usunięcie, gdy liczność spada do 0.
+        if (i >= window) {
+            char out = text[i - window];
+            CountHeap::Handle h = handles[out];
+            WindowCount c = heap.get(h);
+            if (c.count == 1) {
+                heap.erase(h);
+                handles.erase(out);
+            } else {
+                heap.decreaseKey(h, {c.count - 1, out});
+            }
+        }
+
+        if (i + 1 >= window) {
+            const WindowCount& rarest = heap.peekMin();
+            std::cout << "[OKNO] " << text.substr(i + 1 - window, window)
+                      << " -> najrzadszy: " << rarest.symbol << "(" << rarest.count << ")"
+                      << ", symboli: " << heap.getSize() << "\n";
+        }
+    }
+}
+
+void runHeapDemo() {
+    std::cout << "=== HEAP DEMO ===\n";
+
+    DemoItem items[] = {
+        {"A", 5},
+        {"B", 2},
+        {"C", 8},
+        {"D", 1},
+        {"E", 3}
+    };
+
+    MinHeap<DemoItem> heap(10, lessDemoItem);
+    heap.buildFromArray(items, 5);
+
+    std::cout << "[BUILD FROM ARRAY]\n";
+    heap.debugPrint([](const DemoItem& x) {
+        std::cout << x.name << "(" << x.priority << ") ";
+    });
+    std::cout << "\n";
+
+    std::cout << "\n[INSERT] X(4)\n";
+    heap.insert({"X", 4});
+
+    if (heap.getSize() > 1) {
+        std::cout << "\n[DECREASE KEY] index=1, 4 -> 0\n";
+        heap.decreaseKey(1, {"Z", 0});
+    }
+
+    std::cout << "\n[EXTRACT MIN]\n";
+    while (!heap.isEmpty()) {
+        DemoItem m = heap.extractMin();
+        std::cout << m.name << "(" << m.priority << ")\n";
+    }
+
+    std::cout << "\n[ISEMPTY] -> " << (heap.isEmpty() ? "true" : "false") << "\n";
+
+    runIndexedHeapDemo();
+}
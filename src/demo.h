@@ -0,0 +1,7 @@
+#ifndef DEMO_H
+#define DEMO_H
+
+// Krótka demonstracja działania MinHeap i IndexedMinHeap (nie jest częścią Huffmana).
+void runHeapDemo();
+
+#endif
@@ -0,0 +1,120 @@
+#include "dictionary.h"
+#include "format.h"
+#include "histogram.h"
+#include "huffman.h"
+#include "io.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+// FNV-1a (32 bity) z tablicy długości kodów.
+static uint32_t dictionaryId(const CodeLengths& lengths) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t length : lengths) {
+        hash ^= length;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Dictionary Dictionary::fromCodeLengths(const CodeLengths& lengths) {
+    Dictionary dictionary;
+    dictionary.id = dictionaryId(lengths);
+    dictionary.lengths = lengths;
+    dictionary.encoder = EncodeTable::fromCodeLengths(lengths);
+    dictionary.decoder = DecodeTable::fromCodeLengths(lengths);
+    return dictionary;
+}
+
+static void addSampleFile(const fs::path& path, Histogram& freq, uint64_t& bytes) {
+    MappedFile mapped(path.string());
+    if (mapped.isMapped()) {
+        addHistogram(mapped.data(), mapped.size(), freq);
+        bytes += mapped.size();
+    } else {
+        std::vector<uint8_t> data = readBinaryFile(path.string());
+        addHistogram(data.data(), data.size(), freq);
+        bytes += data.size();
+    }
+}
+
+/*
+    Trening: częstotliwości bajtów ze wszystkich próbek + 1 dla każdego bajtu
+    (żeby każdy dostał kod), potem drzewo Huffmana i ewentualnie package-merge.
+*/
+Dictionary trainDictionary(const std::vector<std::string>& samples, int maxCodeLength, uint64_t* sampleBytes) {
+    // 256 symboli wymaga kodów co najmniej 8-bitowych.
+    if (maxCodeLength < 8 || maxCodeLength > MAX_CODE_LENGTH) {
+        throw std::runtime_error("Limit dlugosci kodu slownika musi byc w zakresie 8.." +
+                                 std::to_string(MAX_CODE_LENGTH));
+    }
+
+    Histogram freq{};
+    uint64_t bytes = 0;
+    for (const std::string& sample : samples) {
+        if (fs::is_directory(sample)) {
+            for (const fs::directory_entry& entry : fs::recursive_directory_iterator(sample)) {
+                if (entry.is_regular_file()) addSampleFile(entry.path(), freq, bytes);
+            }
+        } else {
+            addSampleFile(sample, freq, bytes);
+        }
+    }
+    if (bytes == 0) throw std::runtime_error("Brak danych do trenowania slownika");
+    for (uint64_t& count : freq) count++;
+
+    HuffmanTree tree;
+    buildHuffmanTree(freq, tree);
+    CodeLengths lengths{};
+    computeCodeLengths(tree, lengths);
+    if (*std::max_element(lengths.begin(), lengths.end()) > maxCodeLength) {
+        packageMerge(freq, maxCodeLength, lengths);
+    }
+
+    if (sampleBytes) *sampleBytes = bytes;
+    return Dictionary::fromCodeLengths(lengths);
+}
+
+void saveDictionary(const std::string& filename, const Dictionary& dictionary) {
+    std::vector<uint8_t> out(DICTIONARY_MAGIC, DICTIONARY_MAGIC + 4);
+    appendU32(out, dictionary.id);
+    appendCodeLengths(out, dictionary.lengths);
+    writeBinaryFile(filename, out);
+}
+
+static Dictionary readDictionary(const std::string& filename) {
+    std::vector<uint8_t> bytes = readBinaryFile(filename);
+    ByteReader in(bytes.data(), bytes.size());
+    const uint8_t* magic = in.bytes(4);
+    if (!std::equal(DICTIONARY_MAGIC, DICTIONARY_MAGIC + 4, magic)) {
+        throw std::runtime_error("To nie jest plik slownika: " + filename);
+    }
+
+    uint32_t id = in.u32();
+    CodeLengths lengths = readCodeLengths(in);
+    for (uint8_t length : lengths) {
+        if (length == 0 || length > MAX_CODE_LENGTH) throw std::runtime_error("Uszkodzony slownik: " + filename);
+    }
+
+    Dictionary dictionary = Dictionary::fromCodeLengths(lengths);
+    if (dictionary.id != id) throw std::runtime_error("Uszkodzony slownik: " + filename);
+    return dictionary;
+}
+
+std::shared_ptr<const Dictionary> loadDictionary(const std::string& filename) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const Dictionary>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(filename);
+    if (it != cache.end()) return it->second;
+
+    auto dictionary = std::make_shared<const Dictionary>(readDictionary(filename));
+    cache.emplace(filename, dictionary);
+    return dictionary;
+}
@@ -0,0 +1,50 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include "canonical.h"
+#include "decoder.h"
+#include "encoder.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+  Słownik: tablica kodów wytrenowana na próbkach i zapisana w osobnym pliku.
+
+  Przy małych wiadomościach nagłówek z długościami kodów bywa większy niż same dane,
+  a budowa drzewa kosztuje więcej niż kodowanie. Ze słownikiem plik skompresowany
+  zawiera tylko jego ID, a tablice kodera i dekodera są budowane raz na proces.
+  Kod ma każdy z 256 bajtów (także nieobecny w próbkach), więc słownik pasuje do
+  dowolnych danych – tylko kompresja jest gorsza, gdy rozkład odbiega od próbek.
+
+  Plik słownika: "HDIC" | id (u32) | długości kodów
+  ID = skrót (FNV-1a) długości kodów, więc pliki o tej samej tablicy mają to samo ID.
+*/
+constexpr char DICTIONARY_MAGIC[4] = {'H', 'D', 'I', 'C'};
+
+struct Dictionary {
+    uint32_t id = 0;
+    CodeLengths lengths{};
+    EncodeTable encoder;
+    DecodeTable decoder;
+
+    // Słownik z gotowych długości kodów (ID i tablice liczone tutaj).
+    static Dictionary fromCodeLengths(const CodeLengths& lengths);
+};
+
+// Trenuje słownik na plikach próbek (katalogi – rekurencyjnie); zwraca też liczbę bajtów próbek.
+Dictionary trainDictionary(const std::vector<std::string>& samples, int maxCodeLength,
+                           uint64_t* sampleBytes = nullptr);
+
+void saveDictionary(const std::string& filename, const Dictionary& dictionary);
+
+/*
+  Wczytuje słownik z pliku. Wynik jest zapamiętywany (po nazwie pliku) do końca procesu,
+  więc kolejne wywołania – np. dla każdego pliku w trybie katalogowym – nie czytają
+  pliku ani nie budują tablic ponownie. Bezpieczne z wielu wątków.
+*/
+std::shared_ptr<const Dictionary> loadDictionary(const std::string& filename);
+
+#endif
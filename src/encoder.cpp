@@ -0,0 +1,134 @@
+#include "encoder.h"
+#include "bitio.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+EncodeTable EncodeTable::fromCodeLengths(const CodeLengths& lengths) {
+    // Bufor kodów na wątek – kolejne tablice (np. dla każdego bloku) nie alokują pamięci.
+    thread_local std::vector<CodeWord> codes;
+    assignCanonicalCodes(lengths, codes);
+
+    EncodeTable table;
+    for (const CodeWord& cw : codes) {
+        if (cw.length > MAX_CODE_LENGTH) throw std::runtime_error("Za dlugi kod do zakodowania");
+        table.entries[cw.symbol] = EncodeEntry{static_cast<uint32_t>(cw.code), cw.length};
+        table.longest = std::max(table.longest, static_cast<int>(cw.length));
+    }
+    return table;
+}
+
+/*
+    Pętla kodująca z UNROLL kodami na jeden flush().
+    UNROLL * najdłuższy kod <= 56, więc rejestr nigdy się nie przepełni.
+    lookup(i) zwraca kod i-tego symbolu (order-0: z jednej tablicy, order-1: zależnie od poprzedniego).
+*/
+template <int UNROLL, typename Lookup>
+static uint64_t encodeSymbols(size_t size, const Lookup& lookup, uint8_t* out, uint8_t*& end) {
+    BitWriter writer(out);
+
+    size_t i = 0;
+    for (; i + UNROLL <= size; i += UNROLL) {
+        for (int k = 0; k < UNROLL; ++k) {
+            const EncodeEntry& e = lookup(i + k);
+            writer.put(e.code, static_cast<int>(e.length));
+        }
+        writer.flush();
+    }
+
+    for (; i < size; ++i) {
+        const EncodeEntry& e = lookup(i);
+        writer.put(e.code, static_cast<int>(e.length));
+        writer.flush();
+    }
+
+    uint64_t bits = writer.bitsSince(out);
+    end = writer.finish();
+    return bits;
+}
+
+// Rezerwuje miejsce w out, wybiera wariant pętli dla 'unroll' i przycina out do końca danych.
+template <typename Lookup>
+static uint64_t encodeInto(size_t size, int longest, int unroll, const Lookup& lookup, std::vector<uint8_t>& out) {
+    int safe = std::min(EncodeTable::MAX_UNROLL, 56 / longest);
+    unroll = (unroll <= 0) ? safe : std::min(unroll, safe);
+
+    // Najgorszy przypadek: każdy bajt ma najdłuższy kod (+8 bajtów zapasu dla flush()).
+    size_t start = out.size();
+    out.resize(start + (size * longest + 7) / 8 + 8);
+
+    uint8_t* begin = out.data() + start;
+    uint8_t* end = nullptr;
+    uint64_t bits = 0;
+    switch (unroll) {
+        case 4:  bits = encodeSymbols<4>(size, lookup, begin, end); break;
+        case 3:  bits = encodeSymbols<3>(size, lookup, begin, end); break;
+        case 2:  bits = encodeSymbols<2>(size, lookup, begin, end); break;
+        default: bits = encodeSymbols<1>(size, lookup, begin, end); break;
+    }
+
+    out.resize(static_cast<size_t>(end - out.data()));
+    return bits;
+}
+
+uint64_t EncodeTable::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int unroll) const {
+    if (size == 0) return 0;
+    if (longest == 0) throw std::runtime_error("Brak kodow do zakodowania danych");
+
+    auto lookup = [&](size_t i) -> const EncodeEntry& { return entries[data[i]]; };
+    return encodeInto(size, longest, unroll, lookup, out);
+}
+
+uint64_t EncodeTable::encodeWithContext(const std::vector<EncodeTable>& tables, const ContextMap& map,
+                                        const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    if (size == 0) return 0;
+
+    // Wskaźnik na tablicę każdego kontekstu – jeden odczyt zamiast map + tables.
+    const EncodeEntry* byContext[ALPHABET_SIZE];
+    int longest = 0;
+    for (int c = 0; c < ALPHABET_SIZE; ++c) {
+        if (map[c] >= tables.size()) throw std::runtime_error("Brak tablicy kodow dla kontekstu");
+        byContext[c] = tables[map[c]].entries;
+    }
+    for (const EncodeTable& table : tables) longest = std::max(longest, table.longest);
+    if (longest == 0) throw std::runtime_error("Brak kodow do zakodowania danych");
+
+    auto lookup = [&](size_t i) -> const EncodeEntry& {
+        return byContext[i > 0 ? data[i - 1] : 0][data[i]];
+    };
+    return encodeInto(size, longest, 0, lookup, out);
+}
+
+WideEncodeTable WideEncodeTable::fromCodeLengths(const WideCodeLengths& lengths) {
+    WideEncodeTable table;
+    table.assign(lengths);
+    return table;
+}
+
+/*
+    Pozycji par nieużytych w bloku nie zerujemy: koder sięga tylko po pary z danych,
+    dla których długości zostały policzone, więc stare wpisy nigdy nie są czytane.
+*/
+void WideEncodeTable::assign(const WideCodeLengths& lengths) {
+    thread_local std::vector<CodeWord> codes;
+    assignCanonicalCodes(lengths.data(), lengths.size(), codes);
+
+    entries.resize(WIDE_ALPHABET_SIZE);
+    longest = 0;
+    for (const CodeWord& cw : codes) {
+        if (cw.length > MAX_CODE_LENGTH) throw std::runtime_error("Za dlugi kod do zakodowania");
+        entries[cw.symbol] = EncodeEntry{static_cast<uint32_t>(cw.code), cw.length};
+        longest = std::max(longest, static_cast<int>(cw.length));
+    }
+}
+
+uint64_t WideEncodeTable::encode(const uint8_t* data, size_t pairs, std::vector<uint8_t>& out) const {
+    if (pairs == 0) return 0;
+    if (longest == 0) throw std::runtime_error("Brak kodow do zakodowania danych");
+
+    const EncodeEntry* table = entries.data();
+    auto lookup = [&](size_t i) -> const EncodeEntry& {
+        return table[data[2 * i] | (data[2 * i + 1] << 8)];
+    };
+    return encodeInto(pairs, longest, 0, lookup, out);
+}
@@ -0,0 +1,76 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "canonical.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Kod jednego bajtu gotowy do zapisu (bez mapy znak -> napis).
+struct EncodeEntry {
+    uint32_t code;
+    uint32_t length;
+};
+
+/*
+  Tablicowy koder: płaska tablica 256 par (kod, długość) indeksowana bajtem
+  i 64-bitowy BitWriter. Pętla kodująca dopisuje kilka kodów do rejestru
+  i dopiero wtedy zapisuje pełne bajty (flush), więc nie ma pracy "na bit".
+*/
+class EncodeTable {
+public:
+    // Ile kodów najwyżej dopisujemy między kolejnymi flush().
+    static constexpr int MAX_UNROLL = 4;
+
+    EncodeTable() = default;
+
+    // Kody kanoniczne z długości (każda <= MAX_CODE_LENGTH).
+    static EncodeTable fromCodeLengths(const CodeLengths& lengths);
+
+    /*
+      Koduje size bajtów i dopisuje strumień na koniec out. Zwraca liczbę ważnych bitów.
+      unroll = ile symboli między flush(): 0 = najwięcej, ile pozwala najdłuższy kod.
+    */
+    uint64_t encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int unroll = 0) const;
+
+    /*
+      Kodowanie order-1: bajt data[i] dostaje kod z tables[map[data[i - 1]]],
+      a pierwszy bajt – z tablicy kontekstu 0. Dopisuje strumień na koniec out.
+    */
+    static uint64_t encodeWithContext(const std::vector<EncodeTable>& tables, const ContextMap& map,
+                                      const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    [[nodiscard]] const EncodeEntry& operator[](uint8_t symbol) const { return entries[symbol]; }
+    [[nodiscard]] int maxLength() const { return longest; }
+
+private:
+    EncodeEntry entries[ALPHABET_SIZE] = {};
+    int longest = 0;
+};
+
+/*
+  Koder par bajtów (--symbol-bits=16): ta sama pętla co EncodeTable, ale tablica
+  ma WIDE_ALPHABET_SIZE pozycji indeksowanych parą data[2i] | data[2i + 1] << 8,
+  więc jeden odczyt z tablicy koduje dwa bajty.
+*/
+class WideEncodeTable {
+public:
+    WideEncodeTable() = default;
+
+    static WideEncodeTable fromCodeLengths(const WideCodeLengths& lengths);
+
+    // To samo w istniejącym obiekcie (tablica 65536 pozycji nie jest alokowana od nowa).
+    void assign(const WideCodeLengths& lengths);
+
+    // Koduje 'pairs' par bajtów (2 * pairs bajtów data) i dopisuje strumień na koniec out.
+    uint64_t encode(const uint8_t* data, size_t pairs, std::vector<uint8_t>& out) const;
+
+    [[nodiscard]] int maxLength() const { return longest; }
+
+private:
+    std::vector<EncodeEntry> entries;
+    int longest = 0;
+};
+
+#endif
@@ -0,0 +1,495 @@
+#include "format.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static uint32_t loadLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint64_t loadLE64(const uint8_t* p) {
+    return static_cast<uint64_t>(loadLE32(p)) | (static_cast<uint64_t>(loadLE32(p + 4)) << 32);
+}
+
+uint8_t ByteReader::u8() {
+    return *bytes(1);
+}
+
+uint32_t ByteReader::u32() {
+    return loadLE32(bytes(4));
+}
+
+uint64_t ByteReader::u64() {
+    return loadLE64(bytes(8));
+}
+
+const uint8_t* ByteReader::bytes(size_t n) {
+    if (n > size - pos) throw std::runtime_error("Uszkodzony plik: nieoczekiwany koniec danych");
+    const uint8_t* p = data + pos;
+    pos += n;
+    return p;
+}
+
+uint8_t StreamReader::u8() {
+    return *bytes(1);
+}
+
+uint32_t StreamReader::u32() {
+    return loadLE32(bytes(4));
+}
+
+uint64_t StreamReader::u64() {
+    return loadLE64(bytes(8));
+}
+
+const uint8_t* StreamReader::bytes(size_t n) {
+    scratch.resize(n);
+    read(scratch.data(), n);
+    return scratch.data();
+}
+
+void StreamReader::read(uint8_t* dst, size_t n) {
+    size_t fromLookahead = std::min(n, lookahead.size());
+    std::copy(lookahead.begin(), lookahead.begin() + fromLookahead, dst);
+    lookahead.erase(lookahead.begin(), lookahead.begin() + fromLookahead);
+
+    size_t rest = n - fromLookahead;
+    if (rest > 0) {
+        in.read(reinterpret_cast<char*>(dst + fromLookahead), static_cast<std::streamsize>(rest));
+        if (static_cast<size_t>(in.gcount()) != rest) {
+            throw std::runtime_error("Uszkodzony plik: nieoczekiwany koniec danych");
+        }
+    }
+    consumed += n;
+}
+
+size_t StreamReader::peek(size_t n, const uint8_t*& data) {
+    if (lookahead.size() < n) {
+        size_t have = lookahead.size();
+        lookahead.resize(n);
+        in.read(reinterpret_cast<char*>(lookahead.data() + have), static_cast<std::streamsize>(n - have));
+        lookahead.resize(have + static_cast<size_t>(in.gcount()));
+        if (in.eof()) in.clear(in.rdstate() & ~(std::ios::eofbit | std::ios::failbit));
+    }
+    data = lookahead.data();
+    return std::min(n, lookahead.size());
+}
+
+size_t StreamReader::readSome(uint8_t* dst, size_t n) {
+    if (n == 0) return 0;
+
+    if (!lookahead.empty()) {
+        size_t got = std::min(n, lookahead.size());
+        read(dst, got);
+        return got;
+    }
+
+    // Najpierw to, co strumień ma już w buforze; gdy nic – czekamy na jeden bajt.
+    std::streamsize got = in.readsome(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
+    if (got <= 0) {
+        int c = in.get();
+        if (c == std::char_traits<char>::eof()) {
+            if (in.bad()) throw std::runtime_error("Blad odczytu danych");
+            return 0;
+        }
+        dst[0] = static_cast<uint8_t>(c);
+        got = 1 + std::max<std::streamsize>(0, in.readsome(reinterpret_cast<char*>(dst + 1),
+                                                           static_cast<std::streamsize>(n - 1)));
+    }
+
+    consumed += static_cast<uint64_t>(got);
+    return static_cast<size_t>(got);
+}
+
+std::vector<uint8_t> StreamReader::readToEnd() {
+    std::vector<uint8_t> bytes;
+    bytes.swap(lookahead);
+
+    char chunk[1 << 16];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + in.gcount());
+    }
+    if (in.bad()) throw std::runtime_error("Blad odczytu danych");
+
+    consumed += bytes.size();
+    return bytes;
+}
+
+void appendU8(std::vector<uint8_t>& out, uint8_t v) {
+    out.push_back(v);
+}
+
+void appendU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+void patchU32(std::vector<uint8_t>& out, size_t pos, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void appendU64(std::vector<uint8_t>& out, uint64_t v) {
+    appendU32(out, static_cast<uint32_t>(v));
+    appendU32(out, static_cast<uint32_t>(v >> 32));
+}
+
+/*
+    Długości kodów w nagłówku.
+    Większość z 256 bajtów zwykle nie występuje (długość 0), więc zapisujemy
+    je jako serie (długość, liczba powtórzeń - 1), a przy kilku symbolach jako
+    pary (symbol, długość). Gdy obie postacie są dłuższe niż zwykła tablica
+    256 bajtów, zapisujemy tablicę – zawsze wybieramy najkrótszą postać.
+*/
+void appendCodeLengths(std::vector<uint8_t>& out, const CodeLengths& lengths) {
+    std::vector<uint8_t> sparse;
+    sparse.push_back(LENGTHS_SPARSE);
+    sparse.push_back(0);
+    for (int i = 0; i < ALPHABET_SIZE && sparse.size() <= 1 + ALPHABET_SIZE; ++i) {
+        if (lengths[i] == 0) continue;
+        sparse[1]++;
+        sparse.push_back(static_cast<uint8_t>(i));
+        sparse.push_back(lengths[i]);
+    }
+
+    std::vector<uint8_t> rle;
+    rle.push_back(LENGTHS_RLE);
+    for (int i = 0; i < ALPHABET_SIZE;) {
+        int run = 1;
+        while (i + run < ALPHABET_SIZE && lengths[i + run] == lengths[i]) run++;
+        rle.push_back(lengths[i]);
+        rle.push_back(static_cast<uint8_t>(run - 1));
+        i += run;
+    }
+
+    if (sparse.size() <= rle.size() && sparse.size() <= 1 + ALPHABET_SIZE) {
+        out.insert(out.end(), sparse.begin(), sparse.end());
+    } else if (rle.size() <= 1 + ALPHABET_SIZE) {
+        out.insert(out.end(), rle.begin(), rle.end());
+    } else {
+        out.push_back(LENGTHS_RAW);
+        out.insert(out.end(), lengths.begin(), lengths.end());
+    }
+}
+
+// Czy w danych zostało jeszcze 'bytes' bajtów (ze strumienia nie wiadomo – sprawdzi to sam odczyt).
+static bool available(const ByteReader& in, uint64_t bytes) {
+    return bytes <= in.remaining();
+}
+
+static bool available(const StreamReader&, uint64_t) {
+    return true;
+}
+
+template <typename Reader>
+CodeLengths readCodeLengths(Reader& in) {
+    CodeLengths lengths{};
+
+    uint8_t encoding = in.u8();
+
+    if (encoding == LENGTHS_RAW) {
+        const uint8_t* raw = in.bytes(ALPHABET_SIZE);
+        std::copy(raw, raw + ALPHABET_SIZE, lengths.begin());
+        return lengths;
+    }
+
+    if (encoding == LENGTHS_SPARSE) {
+        uint8_t count = in.u8();
+        for (int i = 0; i < count; ++i) {
+            uint8_t symbol = in.u8();
+            lengths[symbol] = in.u8();
+        }
+        return lengths;
+    }
+
+    if (encoding != LENGTHS_RLE) throw std::runtime_error("Uszkodzony plik: nieznany zapis dlugosci kodow");
+
+    for (int i = 0; i < ALPHABET_SIZE;) {
+        uint8_t length = in.u8();
+        int run = in.u8() + 1;
+        if (i + run > ALPHABET_SIZE) throw std::runtime_error("Uszkodzony plik: blad dlugosci kodow");
+
+        for (int k = 0; k < run; ++k) lengths[i + k] = length;
+        i += run;
+    }
+
+    return lengths;
+}
+
+static void appendVarint(std::vector<uint8_t>& out, uint32_t v) {
+    for (; v >= 0x80; v >>= 7) out.push_back(static_cast<uint8_t>(v | 0x80));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+template <typename Reader>
+static uint32_t readVarint(Reader& in) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = in.u8();
+        v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+    throw std::runtime_error("Uszkodzony plik: blad dlugosci kodow");
+}
+
+/*
+    Dla par bajtów tablica 65536 długości byłaby większa niż sam blok tekstu,
+    a serie z licznikiem do 256 nadal kosztowałyby setki bajtów samych zer.
+    Zapisujemy więc tylko użyte symbole: odstęp od poprzedniego i długość w jednej
+    liczbie o zmiennej długości – sąsiednie symbole (np. litery po spacji) zajmują
+    po jednym bajcie.
+*/
+void appendWideCodeLengths(std::vector<uint8_t>& out, const WideCodeLengths& lengths) {
+    size_t countPos = out.size();
+    appendU32(out, 0);
+
+    uint32_t count = 0, gap = 0;
+    for (uint8_t length : lengths) {
+        if (length == 0) {
+            gap++;
+            continue;
+        }
+        appendVarint(out, (gap << 5) | length);
+        count++;
+        gap = 0;
+    }
+    patchU32(out, countPos, count);
+}
+
+template <typename Reader>
+void readWideCodeLengths(Reader& in, WideCodeLengths& lengths) {
+    lengths.assign(WIDE_ALPHABET_SIZE, 0);
+
+    uint32_t count = in.u32();
+    if (count > WIDE_ALPHABET_SIZE) throw std::runtime_error("Uszkodzony plik: blad dlugosci kodow");
+    size_t symbol = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t v = readVarint(in);
+        symbol += v >> 5;
+        if (symbol >= WIDE_ALPHABET_SIZE || (v & 31) == 0) {
+            throw std::runtime_error("Uszkodzony plik: blad dlugosci kodow");
+        }
+        lengths[symbol++] = static_cast<uint8_t>(v & 31);
+    }
+}
+
+uint8_t detectFormat(const uint8_t* data, size_t size) {
+    // Stary format zaczyna się od dictSize <= 256, więc nie da się go pomylić z "HUF" + wersja.
+    if (size >= 4 && std::equal(FORMAT_MAGIC, FORMAT_MAGIC + 3, data)) return data[3];
+    return 0;
+}
+
+void appendContainerHeader(std::vector<uint8_t>& out, const ContainerHeader& header) {
+    out.insert(out.end(), FORMAT_MAGIC, FORMAT_MAGIC + 3);
+    appendU8(out, FORMAT_BLOCKS);
+    appendU8(out, header.flags);
+    appendU32(out, header.blockSize);
+    if (header.flags & FILE_SHARED_TABLE) appendCodeLengths(out, header.sharedLengths);
+}
+
+template <typename Reader>
+ContainerHeader readContainerHeader(Reader& in) {
+    const uint8_t* magic = in.bytes(4);
+    if (!std::equal(FORMAT_MAGIC, FORMAT_MAGIC + 3, magic) || magic[3] != FORMAT_BLOCKS) {
+        throw std::runtime_error("Uszkodzony plik: to nie jest plik w formacie blokowym");
+    }
+
+    ContainerHeader header;
+    header.flags = in.u8();
+    header.blockSize = in.u32();
+    if (header.blockSize == 0 || header.blockSize > MAX_BLOCK_SIZE) {
+        throw std::runtime_error("Uszkodzony plik: niepoprawny rozmiar bloku");
+    }
+    if (header.flags & FILE_SHARED_TABLE) header.sharedLengths = readCodeLengths(in);
+    return header;
+}
+
+size_t appendBlockHeader(std::vector<uint8_t>& out, const BlockHeader& header) {
+    appendU32(out, header.rawSize);
+    appendU8(out, header.flags);
+    if (header.flags & BLOCK_CHECKSUM) appendU32(out, header.checksum);
+    if (header.flags & BLOCK_RAW) return out.size();
+    if (header.flags & BLOCK_RLE) {
+        appendU8(out, header.symbol);
+        return out.size();
+    }
+    if (header.flags & BLOCK_OWN_TABLE) appendCodeLengths(out, header.lengths);
+    if (header.flags & BLOCK_WIDE) {
+        appendWideCodeLengths(out, header.wideLengths);
+        if (header.rawSize & 1) appendU8(out, header.lastByte);
+    }
+    if (header.flags & BLOCK_CONTEXT) {
+        // Mapa ma te same cechy co tablica długości (małe liczby, długie serie) – ten sam zapis.
+        appendU8(out, static_cast<uint8_t>(header.contextLengths.size()));
+        appendCodeLengths(out, header.contextMap);
+        for (const CodeLengths& lengths : header.contextLengths) appendCodeLengths(out, lengths);
+    }
+
+    if (!(header.flags & BLOCK_SEGMENTS)) {
+        appendU32(out, header.bitCount);
+        return out.size() - 4;
+    }
+
+    appendU32(out, header.segmentSize);
+    size_t bitsPos = out.size();
+    for (uint32_t bits : header.segmentBits) appendU32(out, bits);
+    return bitsPos;
+}
+
+template <typename Reader>
+void readBlockHeader(Reader& in, BlockHeader& block) {
+    block.rawSize = in.u32();
+    block.flags = 0;
+    block.checksum = 0;
+    block.bitCount = 0;
+    block.segmentSize = 0;
+    block.contextLengths.clear();
+    block.segmentBits.clear();
+    if (block.rawSize == 0) return; // znacznik końca bloków
+    if (block.rawSize > MAX_BLOCK_SIZE) throw std::runtime_error("Uszkodzony plik: za duzy blok");
+
+    block.flags = in.u8();
+    if (block.flags & BLOCK_CHECKSUM) block.checksum = in.u32();
+    if (block.flags & (BLOCK_RAW | BLOCK_RLE)) {
+        // Blok bez kodowania nie ma tablic ani segmentów.
+        uint8_t kind = block.flags & ~BLOCK_CHECKSUM;
+        if (kind != BLOCK_RAW && kind != BLOCK_RLE) {
+            throw std::runtime_error("Uszkodzony plik: niepoprawne flagi bloku");
+        }
+        if (block.flags & BLOCK_RLE) block.symbol = in.u8();
+        return;
+    }
+    if (block.flags & BLOCK_OWN_TABLE) block.lengths = readCodeLengths(in);
+    if (block.flags & BLOCK_WIDE) {
+        if (block.flags & (BLOCK_OWN_TABLE | BLOCK_CONTEXT)) {
+            throw std::runtime_error("Uszkodzony plik: niepoprawne flagi bloku");
+        }
+        readWideCodeLengths(in, block.wideLengths);
+        if (block.rawSize & 1) block.lastByte = in.u8();
+    }
+    if (block.flags & BLOCK_CONTEXT) {
+        size_t tables = in.u8();
+        if (tables == 0 || tables > MAX_CONTEXT_TABLES || (block.flags & BLOCK_OWN_TABLE)) {
+            throw std::runtime_error("Uszkodzony plik: niepoprawne tablice kontekstow");
+        }
+        block.contextMap = readCodeLengths(in);
+        for (uint8_t table : block.contextMap) {
+            if (table >= tables) throw std::runtime_error("Uszkodzony plik: niepoprawne tablice kontekstow");
+        }
+        block.contextLengths.resize(tables);
+        for (CodeLengths& lengths : block.contextLengths) lengths = readCodeLengths(in);
+    }
+
+    if (!(block.flags & BLOCK_SEGMENTS)) {
+        block.bitCount = in.u32();
+        return;
+    }
+
+    // Koder nie tworzy segmentów krótszych niż MIN_SEEK_INTERVAL (chyba że cały blok jest krótszy),
+    // więc mniejszy rozmiar to uszkodzony nagłówek – sprawdzamy go przed rezerwacją tablicy skoków.
+    block.segmentSize = in.u32();
+    if (block.segmentSize == 0 || block.segmentSize < std::min(block.rawSize, MIN_SEEK_INTERVAL) ||
+        ((block.flags & BLOCK_WIDE) && (block.segmentSize & 1))) {
+        throw std::runtime_error("Uszkodzony plik: niepoprawny rozmiar segmentu");
+    }
+    size_t segments = BlockHeader::segmentCount(block.rawSize, block.segmentSize);
+    if (!available(in, static_cast<uint64_t>(segments) * 4)) throw std::runtime_error("Uszkodzony plik: nieoczekiwany koniec danych");
+    block.segmentBits.resize(segments);
+    for (uint32_t& bits : block.segmentBits) bits = in.u32();
+}
+
+template <typename Reader>
+BlockHeader readBlockHeader(Reader& in) {
+    BlockHeader block;
+    readBlockHeader(in, block);
+    return block;
+}
+
+BlockView readBlock(ByteReader& in) {
+    BlockView block;
+    static_cast<BlockHeader&>(block) = readBlockHeader(in);
+    if (block.rawSize > 0) block.data = in.bytes(block.dataSize());
+    return block;
+}
+
+void appendBlockIndex(std::vector<uint8_t>& out, const std::vector<BlockIndexEntry>& index,
+                      uint64_t startOffset, const uint32_t* checksum) {
+    appendU32(out, 0); // znacznik końca bloków (rawSize = 0)
+    if (checksum) appendU32(out, *checksum);
+
+    uint64_t indexOffset = startOffset + out.size();
+    appendU32(out, static_cast<uint32_t>(index.size()));
+    for (const BlockIndexEntry& e : index) {
+        appendU64(out, e.offset);
+        appendU32(out, e.rawSize);
+    }
+
+    appendU64(out, indexOffset);
+    out.insert(out.end(), INDEX_MAGIC, INDEX_MAGIC + 4);
+}
+
+std::vector<BlockIndexEntry> readBlockIndex(const uint8_t* data, size_t size) {
+    constexpr size_t FOOTER_SIZE = 8 + 4;
+    if (size < FOOTER_SIZE || !std::equal(INDEX_MAGIC, INDEX_MAGIC + 4, data + size - 4)) {
+        throw std::runtime_error("Uszkodzony plik: brak indeksu blokow");
+    }
+
+    ByteReader footer(data, size, size - FOOTER_SIZE);
+    uint64_t indexOffset = footer.u64();
+    if (indexOffset > size - FOOTER_SIZE) throw std::runtime_error("Uszkodzony plik: blad indeksu blokow");
+
+    ByteReader in(data, size - FOOTER_SIZE, static_cast<size_t>(indexOffset));
+    uint32_t count = in.u32();
+    if (count > in.remaining() / 12) throw std::runtime_error("Uszkodzony plik: blad indeksu blokow");
+
+    std::vector<BlockIndexEntry> index(count);
+    for (BlockIndexEntry& e : index) {
+        e.offset = in.u64();
+        e.rawSize = in.u32();
+        if (e.offset >= indexOffset || e.rawSize == 0) {
+            throw std::runtime_error("Uszkodzony plik: blad indeksu blokow");
+        }
+    }
+    return index;
+}
+
+template <typename Reader>
+void readTrailingIndex(Reader& in, std::vector<BlockIndexEntry>& index) {
+    uint32_t count = in.u32();
+
+    index.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        BlockIndexEntry e{};
+        e.offset = in.u64();
+        e.rawSize = in.u32();
+        index.push_back(e);
+    }
+
+    in.u64(); // indexOffset (przy czytaniu po kolei już go znamy)
+    const uint8_t* magic = in.bytes(4);
+    if (!std::equal(INDEX_MAGIC, INDEX_MAGIC + 4, magic)) {
+        throw std::runtime_error("Uszkodzony plik: brak indeksu blokow");
+    }
+}
+
+template <typename Reader>
+std::vector<BlockIndexEntry> readTrailingIndex(Reader& in) {
+    std::vector<BlockIndexEntry> index;
+    readTrailingIndex(in, index);
+    return index;
+}
+
+// Jawne konkretyzacje dla obu źródeł danych.
+template CodeLengths readCodeLengths<ByteReader>(ByteReader&);
+template CodeLengths readCodeLengths<StreamReader>(StreamReader&);
+template void readWideCodeLengths<ByteReader>(ByteReader&, WideCodeLengths&);
+template void readWideCodeLengths<StreamReader>(StreamReader&, WideCodeLengths&);
+template ContainerHeader readContainerHeader<ByteReader>(ByteReader&);
+template ContainerHeader readContainerHeader<StreamReader>(StreamReader&);
+template BlockHeader readBlockHeader<ByteReader>(ByteReader&);
+template BlockHeader readBlockHeader<StreamReader>(StreamReader&);
+template void readBlockHeader<ByteReader>(ByteReader&, BlockHeader&);
+template void readBlockHeader<StreamReader>(StreamReader&, BlockHeader&);
+template void readTrailingIndex<ByteReader>(ByteReader&, std::vector<BlockIndexEntry>&);
+template void readTrailingIndex<StreamReader>(StreamReader&, std::vector<BlockIndexEntry>&);
+template std::vector<BlockIndexEntry> readTrailingIndex<ByteReader>(ByteReader&);
+template std::vector<BlockIndexEntry> readTrailingIndex<StreamReader>(StreamReader&);
@@ -0,0 +1,259 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include "canonical.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// Sygnatura plików .huf: "HUF" + numer wersji formatu.
+constexpr char FORMAT_MAGIC[3] = {'H', 'U', 'F'};
+constexpr uint8_t FORMAT_CANONICAL = 2; // jeden strumień, nagłówek z długościami kodów
+constexpr uint8_t FORMAT_BLOCKS    = 3; // kontener z niezależnymi blokami + indeks
+constexpr uint8_t FORMAT_ADAPTIVE  = 4; // adaptacyjny Huffman: sam strumień bitów, bez nagłówka
+constexpr uint8_t FORMAT_DICTIONARY = 5; // kody z osobnego słownika: w pliku tylko jego ID
+
+/*
+  Format słownikowy (wersja 5) – dla małych wiadomości, 16 bajtów nagłówka:
+    "HUF" 5 | dictionaryId (u32) | rawSize (u32) | bitCount (u32) | strumień bitów
+*/
+constexpr size_t DICTIONARY_HEADER_SIZE = 16;
+
+// Sygnatura końca pliku w formacie blokowym (za indeksem bloków).
+constexpr char INDEX_MAGIC[4] = {'H', 'I', 'D', 'X'};
+
+// Domyślny i maksymalny rozmiar bloku (bitCount bloku musi zmieścić się w uint32).
+constexpr uint32_t DEFAULT_BLOCK_SIZE = 1u << 20;
+constexpr uint32_t MAX_BLOCK_SIZE     = 64u << 20;
+
+// Najmniejszy odstęp punktów dostępu swobodnego (--seek-interval), a więc i najmniejszy segment bloku.
+constexpr uint32_t MIN_SEEK_INTERVAL = 1024;
+
+// Sposób zapisu tablicy długości kodów.
+enum LengthsEncoding : uint8_t {
+    LENGTHS_RAW = 0,   // 256 bajtów, po jednym na symbol
+    LENGTHS_RLE = 1,   // pary (długość, liczba powtórzeń - 1)
+    LENGTHS_SPARSE = 2 // liczba symboli + pary (symbol, długość) – dla kilku symboli
+};
+
+// Flagi nagłówka pliku blokowego.
+enum FileFlags : uint8_t {
+    FILE_SHARED_TABLE = 1, // długości kodów wspólne dla bloków bez własnej tablicy
+    FILE_CHECKSUM     = 2  // CRC32C każdego bloku i całych danych (wszystkie bloki mają BLOCK_CHECKSUM)
+};
+
+// Flagi nagłówka bloku.
+enum BlockFlags : uint8_t {
+    BLOCK_OWN_TABLE = 1, // blok ma własne długości kodów
+    BLOCK_SEGMENTS  = 2, // dane bloku podzielone na niezależne strumienie (tablica skoków)
+    BLOCK_CONTEXT   = 4, // order-1: kilka tablic kodów wybieranych przez poprzedni bajt
+    BLOCK_RAW       = 8, // dane bez kodowania (Huffman by nie zmniejszył bloku)
+    BLOCK_RLE       = 16, // cały blok to jeden powtórzony bajt
+    BLOCK_CHECKSUM  = 32, // za flagami CRC32C odtworzonych danych bloku
+    BLOCK_WIDE      = 64  // symbole 16-bitowe: pary bajtów z własną tablicą kodów (--symbol-bits=16)
+};
+
+// Najwięcej tablic kodów w bloku order-1.
+constexpr size_t MAX_CONTEXT_TABLES = 8;
+
+/*
+  Odczyt liczb z bufora w pamięci (little-endian) z kontrolą zakresu:
+  każda próba czytania za końcem danych to uszkodzony/ucięty plik.
+*/
+class ByteReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+
+public:
+    ByteReader(const uint8_t* data, size_t size, size_t pos = 0)
+        : data(data), size(size), pos(pos) {}
+
+    uint8_t u8();
+    uint32_t u32();
+    uint64_t u64();
+
+    // Zwraca wskaźnik na kolejne n bajtów i przesuwa się za nie.
+    const uint8_t* bytes(size_t n);
+
+    [[nodiscard]] size_t position() const { return pos; }
+    [[nodiscard]] size_t remaining() const { return size - pos; }
+};
+
+/*
+  Ten sam interfejs co ByteReader, ale dane czytamy ze strumienia
+  (plik albo potok stdin) – bez wczytywania całości do pamięci.
+  Wskaźnik z bytes()/peek() jest ważny do następnego odczytu.
+*/
+class StreamReader {
+private:
+    std::istream& in;
+    std::vector<uint8_t> scratch;   // ostatnio odczytane bajty (bytes)
+    std::vector<uint8_t> lookahead; // bajty podejrzane przez peek, jeszcze nie zużyte
+    uint64_t consumed = 0;
+
+public:
+    explicit StreamReader(std::istream& in) : in(in) {}
+
+    uint8_t u8();
+    uint32_t u32();
+    uint64_t u64();
+
+    const uint8_t* bytes(size_t n);
+
+    // Czyta n bajtów prosto do bufora wywołującego.
+    void read(uint8_t* dst, size_t n);
+
+    // Podgląda do n bajtów bez zużywania ich (mniej tylko na końcu strumienia); zwraca liczbę.
+    size_t peek(size_t n, const uint8_t*& data);
+
+    /*
+      Czyta to, co jest już dostępne (co najmniej 1 bajt, chyba że to koniec danych),
+      zamiast czekać na pełne n bajtów – potrzebne przy danych napływających na bieżąco.
+    */
+    size_t readSome(uint8_t* dst, size_t n);
+
+    // Wszystkie pozostałe bajty (dla formatów, których nie da się czytać po kawałku).
+    std::vector<uint8_t> readToEnd();
+
+    [[nodiscard]] uint64_t position() const { return consumed; }
+};
+
+// Dopisywanie liczb na koniec bufora (little-endian).
+void appendU8(std::vector<uint8_t>& out, uint8_t v);
+void appendU32(std::vector<uint8_t>& out, uint32_t v);
+void appendU64(std::vector<uint8_t>& out, uint64_t v);
+
+// Nadpisuje wcześniej zarezerwowane 4 bajty (np. bitCount znany dopiero po zakodowaniu).
+void patchU32(std::vector<uint8_t>& out, size_t pos, uint32_t v);
+
+// Długości kodów w najkrótszej postaci (pary symbol/długość, serie albo 256 bajtów).
+// Funkcje read* działają z ByteReader (pamięć) i StreamReader (strumień).
+void appendCodeLengths(std::vector<uint8_t>& out, const CodeLengths& lengths);
+template <typename Reader>
+CodeLengths readCodeLengths(Reader& in);
+
+/*
+  Długości kodów par bajtów (65536 pozycji, zwykle użyte tylko nieliczne):
+    count (u32) | count x varint((odstęp << 5) | długość)
+  odstęp = liczba pominiętych symboli (długość 0) od poprzedniego użytego, długość 1..31.
+*/
+void appendWideCodeLengths(std::vector<uint8_t>& out, const WideCodeLengths& lengths);
+template <typename Reader>
+void readWideCodeLengths(Reader& in, WideCodeLengths& lengths);
+
+/*
+  Format blokowy (wersja 3):
+
+    nagłówek:  "HUF" 3 | flags | blockSize (u32) | [wspólne długości kodów]
+    blok:      rawSize (u32) | flags | [crc32c (u32)] | [długości kodów] | bitCount (u32) | dane
+    blok z BLOCK_SEGMENTS:
+               rawSize (u32) | flags | [crc32c (u32)] | [długości kodów] | segmentSize (u32)
+               | segmentCount x bitCount (u32) | strumienie (każdy od pełnego bajtu)
+    blok z BLOCK_CONTEXT: zamiast długości kodów
+               tableCount (u8) | mapa kontekst -> tablica | tableCount x długości kodów
+    blok z BLOCK_WIDE: zamiast długości kodów
+               długości kodów par bajtów | [ostatni bajt (u8), gdy rawSize nieparzyste]
+    blok z BLOCK_RAW:  rawSize (u32) | flags | rawSize bajtów bez kodowania
+    blok z BLOCK_RLE:  rawSize (u32) | flags | symbol (u8)
+    koniec:    rawSize = 0 | [crc32c całych danych (u32), przy FILE_CHECKSUM]
+    indeks:    blockCount (u32) | blockCount x (offset u64, rawSize u32)
+    stopka:    indexOffset (u64) | "HIDX"
+
+  Bloki są niezależne, więc dzięki indeksowi można je dekodować równolegle.
+  Segment i bloku to symbole [i * segmentSize, (i + 1) * segmentSize) zakodowane
+  osobnym strumieniem; tablica skoków (bitCount segmentów) mówi, gdzie zaczyna się
+  każdy strumień, więc kilka strumieni można dekodować naprzemiennie.
+  W bloku order-1 kontekstem pierwszego bajtu każdego segmentu jest 0.
+  W bloku BLOCK_WIDE symbolem jest para bajtów data[2i] | data[2i + 1] << 8, segmentSize
+  (w bajtach) jest parzysty, a strumień segmentu koduje jego pary; nieparzysty ostatni
+  bajt bloku leży w nagłówku.
+  Sumy kontrolne (FILE_CHECKSUM / BLOCK_CHECKSUM) liczone są z odtworzonych danych,
+  więc dekoder sprawdza je przy dekodowaniu, bez osobnego przejścia po pliku.
+*/
+struct ContainerHeader {
+    uint8_t flags = 0;
+    uint32_t blockSize = DEFAULT_BLOCK_SIZE;
+    CodeLengths sharedLengths{};
+};
+
+// Nagłówek bloku (rawSize = 0 oznacza koniec bloków).
+struct BlockHeader {
+    uint32_t rawSize = 0;
+    uint8_t flags = 0;
+    uint32_t checksum = 0;             // BLOCK_CHECKSUM: CRC32C odtworzonych danych bloku
+    CodeLengths lengths{};
+    ContextMap contextMap{};                 // BLOCK_CONTEXT: kontekst -> numer tablicy
+    std::vector<CodeLengths> contextLengths; // BLOCK_CONTEXT: długości kodów każdej tablicy
+    WideCodeLengths wideLengths;       // BLOCK_WIDE: długości kodów par bajtów
+    uint8_t lastByte = 0;              // BLOCK_WIDE z nieparzystym rawSize: bajt bez pary
+    uint32_t bitCount = 0;             // blok z jednym strumieniem
+    uint32_t segmentSize = 0;          // BLOCK_SEGMENTS: symboli na segment (ostatni może mieć mniej)
+    std::vector<uint32_t> segmentBits; // BLOCK_SEGMENTS: liczba bitów każdego segmentu
+    uint8_t symbol = 0;                // BLOCK_RLE: powtarzany bajt
+
+    // Liczba segmentów dla danego rozmiaru bloku i segmentu.
+    static uint32_t segmentCount(uint32_t rawSize, uint32_t segmentSize) {
+        return (rawSize + segmentSize - 1) / segmentSize;
+    }
+
+    // Liczba bajtów danych za nagłówkiem.
+    [[nodiscard]] size_t dataSize() const {
+        if (flags & BLOCK_RAW) return rawSize;
+        if (flags & BLOCK_RLE) return 0;
+        if (!(flags & BLOCK_SEGMENTS)) return (static_cast<size_t>(bitCount) + 7) / 8;
+        size_t bytes = 0;
+        for (uint32_t bits : segmentBits) bytes += (static_cast<size_t>(bits) + 7) / 8;
+        return bytes;
+    }
+};
+
+// Blok odczytany z bufora (dane wskazują do wnętrza bufora, bez kopiowania).
+struct BlockView : BlockHeader {
+    const uint8_t* data = nullptr;
+};
+
+// Pozycja indeksu: gdzie w pliku zaczyna się blok i ile bajtów odtwarza.
+struct BlockIndexEntry {
+    uint64_t offset;
+    uint32_t rawSize;
+};
+
+// Rozpoznaje wersję formatu po sygnaturze (0 = stary format bez sygnatury).
+uint8_t detectFormat(const uint8_t* data, size_t size);
+
+void appendContainerHeader(std::vector<uint8_t>& out, const ContainerHeader& header);
+template <typename Reader>
+ContainerHeader readContainerHeader(Reader& in);
+
+// Nagłówek bloku; liczby bitów można potem poprawić patchU32 (zwraca pozycję pierwszej z nich).
+size_t appendBlockHeader(std::vector<uint8_t>& out, const BlockHeader& header);
+template <typename Reader>
+BlockHeader readBlockHeader(Reader& in);
+// To samo do istniejącego nagłówka (pamięć jego wektorów jest używana ponownie).
+template <typename Reader>
+void readBlockHeader(Reader& in, BlockHeader& header);
+BlockView readBlock(ByteReader& in);
+
+/*
+  Znacznik końca bloków + indeks + stopka.
+  startOffset = pozycja w pliku, od której zaczyna się 'out' (przy zapisie strumieniowym
+  wcześniejsze bajty są już zapisane i nie ma ich w buforze).
+  checksum = CRC32C całych danych, zapisywany tylko w pliku z FILE_CHECKSUM.
+*/
+void appendBlockIndex(std::vector<uint8_t>& out, const std::vector<BlockIndexEntry>& index,
+                      uint64_t startOffset = 0, const uint32_t* checksum = nullptr);
+
+// Indeks z końca pliku w pamięci (dostęp swobodny, bez czytania bloków).
+std::vector<BlockIndexEntry> readBlockIndex(const uint8_t* data, size_t size);
+
+// Indeks czytany po kolei – zaraz za znacznikiem końca bloków (odczyt strumieniowy).
+template <typename Reader>
+std::vector<BlockIndexEntry> readTrailingIndex(Reader& in);
+template <typename Reader>
+void readTrailingIndex(Reader& in, std::vector<BlockIndexEntry>& index);
+
+#endif
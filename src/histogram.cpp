@@ -0,0 +1,110 @@
+#include "histogram.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Poniżej tego rozmiaru na wątek podział pracy kosztuje więcej, niż zyskuje.
+static constexpr size_t PARALLEL_MIN_CHUNK = 1u << 20;
+
+// 32-bitowe podliczniki zajmują mniej cache; przed przepełnieniem przenosimy je do wyniku.
+static constexpr size_t ROUND_SIZE = size_t(1) << 30;
+
+void addHistogram(const uint8_t* data, size_t size, Histogram& hist) {
+    while (size > 0) {
+        size_t round = std::min(size, ROUND_SIZE);
+
+        uint32_t sub[4][ALPHABET_SIZE] = {};
+        size_t i = 0;
+        for (; i + 8 <= round; i += 8) {
+            uint64_t v;
+            std::memcpy(&v, data + i, 8);
+            sub[0][v & 0xFF]++;
+            sub[1][(v >> 8) & 0xFF]++;
+            sub[2][(v >> 16) & 0xFF]++;
+            sub[3][(v >> 24) & 0xFF]++;
+            sub[0][(v >> 32) & 0xFF]++;
+            sub[1][(v >> 40) & 0xFF]++;
+            sub[2][(v >> 48) & 0xFF]++;
+            sub[3][v >> 56]++;
+        }
+        for (; i < round; ++i) sub[i & 3][data[i]]++;
+
+        for (int c = 0; c < ALPHABET_SIZE; ++c) {
+            hist[c] += static_cast<uint64_t>(sub[0][c]) + sub[1][c] + sub[2][c] + sub[3][c];
+        }
+
+        data += round;
+        size -= round;
+    }
+}
+
+Histogram countHistogram(const uint8_t* data, size_t size) {
+    Histogram hist{};
+    addHistogram(data, size, hist);
+    return hist;
+}
+
+Histogram countHistogram(const uint8_t* data, size_t size, ThreadPool& pool) {
+    size_t parts = std::min<size_t>(pool.size(), size / PARALLEL_MIN_CHUNK);
+    if (parts <= 1) return countHistogram(data, size);
+
+    // Fragmenty wyrównane do 64 bajtów, żeby wątki nie czytały tych samych linii cache.
+    size_t chunk = (size / parts + 63) & ~size_t(63);
+    std::vector<Histogram> partial(parts, Histogram{});
+
+    pool.parallelFor(parts, [&](size_t p) {
+        size_t begin = std::min(size, p * chunk);
+        size_t end = (p + 1 == parts) ? size : std::min(size, begin + chunk);
+        addHistogram(data + begin, end - begin, partial[p]);
+    });
+
+    Histogram hist{};
+    for (const Histogram& part : partial) {
+        for (int c = 0; c < ALPHABET_SIZE; ++c) hist[c] += part[c];
+    }
+    return hist;
+}
+
+void countContextHistograms(const uint8_t* data, size_t size, size_t segmentSize,
+                            std::vector<Histogram>& contexts) {
+    contexts.assign(ALPHABET_SIZE, Histogram{});
+    if (segmentSize == 0) segmentSize = size;
+
+    for (size_t first = 0; first < size; first += segmentSize) {
+        size_t last = std::min(size, first + segmentSize);
+        contexts[0][data[first]]++;
+        for (size_t i = first + 1; i < last; ++i) contexts[data[i - 1]][data[i]]++;
+    }
+}
+
+/*
+    Przy 65536 licznikach powtórzenia tej samej pary zaraz po sobie są rzadkie,
+    więc wystarczy jeden histogram. Symbol składamy z bajtów (jak koder: młodszy bajt
+    pierwszy), a nie z odczytu słowa – wynik nie zależy od kolejności bajtów procesora.
+*/
+static inline uint32_t pairAt(const uint8_t* data, size_t i) {
+    return data[2 * i] | (static_cast<uint32_t>(data[2 * i + 1]) << 8);
+}
+
+void countPairHistogram(const uint8_t* data, size_t pairs, WideHistogram& hist) {
+    hist.assign(WIDE_ALPHABET_SIZE, 0);
+
+    size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        hist[pairAt(data, i)]++;
+        hist[pairAt(data, i + 1)]++;
+        hist[pairAt(data, i + 2)]++;
+        hist[pairAt(data, i + 3)]++;
+    }
+    for (; i < pairs; ++i) hist[pairAt(data, i)]++;
+}
+
+int usedSymbols(const Histogram& hist) {
+    return static_cast<int>(std::count_if(hist.begin(), hist.end(), [](uint64_t f) { return f > 0; }));
+}
+
+int usedSymbols(const WideHistogram& hist) {
+    return static_cast<int>(std::count_if(hist.begin(), hist.end(), [](uint64_t f) { return f > 0; }));
+}
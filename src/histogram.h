@@ -0,0 +1,57 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "canonical.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Liczba wystąpień każdego bajtu (64 bity – bez przepełnienia nawet dla ogromnych plików).
+using Histogram = std::array<uint64_t, ALPHABET_SIZE>;
+
+// Liczba wystąpień każdej pary bajtów (WIDE_ALPHABET_SIZE liczników).
+using WideHistogram = std::vector<uint64_t>;
+
+/*
+  Zliczanie bajtów w płaskiej tablicy zamiast mapy haszującej.
+
+  Kolejne bajty często są takie same (np. spacje, zera), a inkrementacja tego samego
+  licznika raz za razem czeka na poprzedni zapis (store-to-load). Dlatego bajty
+  rozdzielamy na 4 przeplatane podhistogramy i sumujemy je dopiero na końcu.
+  Dane czytamy po 8 bajtów naraz i rozbijamy przesunięciami.
+*/
+void addHistogram(const uint8_t* data, size_t size, Histogram& hist);
+
+// Histogram danych (od zera).
+Histogram countHistogram(const uint8_t* data, size_t size);
+
+/*
+  Histogram dużych danych na puli wątków: każdy wątek liczy częściowy histogram
+  swojego fragmentu, a na końcu je sumujemy. Małe dane liczymy na jednym wątku.
+*/
+Histogram countHistogram(const uint8_t* data, size_t size, ThreadPool& pool);
+
+/*
+  Histogramy order-1: contexts[p][c] = ile razy bajt c wystąpił zaraz po bajcie p.
+  Dane są dzielone na segmenty po segmentSize bajtów (0 = całość), a pierwszy bajt
+  segmentu ma kontekst 0 – tak samo jak w koderze i dekoderze.
+*/
+void countContextHistograms(const uint8_t* data, size_t size, size_t segmentSize,
+                            std::vector<Histogram>& contexts);
+
+/*
+  Histogram par bajtów: symbol i-tej pary to data[2i] | data[2i + 1] << 8 (pierwszy bajt
+  młodszy). Liczy 'pairs' par od początku danych; hist jest zerowany i ma rozmiar
+  WIDE_ALPHABET_SIZE (jego pamięć jest używana ponownie).
+*/
+void countPairHistogram(const uint8_t* data, size_t pairs, WideHistogram& hist);
+
+// Liczba symboli, które wystąpiły co najmniej raz.
+int usedSymbols(const Histogram& hist);
+int usedSymbols(const WideHistogram& hist);
+
+#endif
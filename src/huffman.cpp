@@ -1,236 +1,1849 @@
 #include "huffman.h"
 #include "io.h"
+#include "decoder.h"
+#include "encoder.h"
+#include "format.h"
+#include "threadpool.h"
+#include "histogram.h"
+#include "context.h"
 #include "minheap.h"
+#include "adaptive.h"
+#include "dictionary.h"
+#include "stats.h"
+#include "crc32c.h"
+#include "pipeline.h"
 
 #include <unordered_map>
+#include <algorithm>
 #include <vector>
-#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
+/*
+    Element kopca przy budowie drzewa: częstotliwość i indeks węzła w HuffmanTree.
+    Porównanie nie musi sięgać do tablicy węzłów.
+*/
+struct TreeHeapItem {
+    uint64_t freq;
+    int node;
+};
+
 /*
     Comparator do MinHeap:
     Chcemy kopiec minimalny po częstotliwości, więc "mniejsze freq" ma wyższy priorytet.
+    Obiekt funkcyjny (a nie wskaźnik na funkcję), więc porównanie jest wstawiane w kod kopca.
 */
-bool compareHuffmanNodes(HuffmanNode* const& a, HuffmanNode* const& b) {
-    return a->freq < b->freq;
-}
+struct TreeHeapLess {
+    bool operator()(const TreeHeapItem& a, const TreeHeapItem& b) const {
+        return a.freq < b.freq;
+    }
+};
 
 /*
-    Krok 1 (Huffman): zliczamy ile razy występuje każdy znak.
+    Krok 1 (Huffman): zliczamy ile razy występuje każdy znak (countHistogram, histogram.h).
     To na tej podstawie budujemy drzewo (znaki częstsze -> krótsze kody).
-*/
-static std::unordered_map<char, int> countFrequencies(const std::string& text) {
-    std::unordered_map<char, int> freq;
-    for (char c : text) freq[c]++;
-    return freq;
-}
 
-/*
     Krok 2 (Huffman): budowa drzewa z użyciem kopca minimalnego.
     Idea: zawsze łączymy dwa NAJRZADSZE symbole/węzły w nowy węzeł-rodzic.
     Powtarzamy aż zostanie jeden węzeł (korzeń drzewa).
 */
-static HuffmanNode* buildHuffmanTree(const std::unordered_map<char, int>& freq) {
-    if (freq.empty()) return nullptr;
+template <typename Freq>
+void buildHuffmanTreeHeap(const Freq& freq, HuffmanTree& tree) {
+    const int symbols = static_cast<int>(freq.size());
+    tree.reset(freq.size());
 
-    // Tworzymy liście dla każdego znaku.
-    std::vector<HuffmanNode*> nodes;
-    for (const auto& [ch, f] : freq) {
-        nodes.push_back(new HuffmanNode(ch, f));
+    // Tworzymy liście dla każdego występującego znaku (bufor na wątek – bez alokacji przy każdym drzewie).
+    thread_local std::vector<TreeHeapItem> items;
+    items.clear();
+    for (int c = 0; c < symbols; ++c) {
+        if (freq[c] > 0) items.push_back(TreeHeapItem{freq[c], tree.addLeaf(c, freq[c])});
     }
+    int n = static_cast<int>(items.size());
+    if (n == 0) return;
 
-    // MinHeap pozwala szybko brać dwa najmniejsze elementy (extractMin).
-    MinHeap<HuffmanNode*> heap(nodes.size(), compareHuffmanNodes);
-    heap.buildFromArray(nodes.data(), nodes.size());
+    // MinHeap pozwala szybko brać dwa najmniejsze elementy (extractMin); 4-arny = płytszy.
+    MinHeap<TreeHeapItem, TreeHeapLess, 4> heap(n);
+    heap.buildFromArray(items.data(), n);
 
     while (heap.getSize() > 1) {
-        HuffmanNode* left  = heap.extractMin();
-        HuffmanNode* right = heap.extractMin();
+        TreeHeapItem left  = heap.extractMin();
+        TreeHeapItem right = heap.extractMin();
 
         // Rodzic nie reprezentuje znaku, tylko sumę częstotliwości dzieci.
-        heap.insert(new HuffmanNode(left, right));
+        int parent = tree.addInternal(left.node, right.node);
+        heap.insert(TreeHeapItem{tree.nodes[parent].freq, parent});
     }
 
-    return heap.extractMin(); // korzeń drzewa Huffmana
+    tree.root = heap.extractMin().node; // korzeń drzewa Huffmana
 }
 
 /*
-    Krok 3 (Huffman): generowanie kodów.
-    Kod znaku = ścieżka w drzewie: lewo -> '0', prawo -> '1'.
-    Dzięki temu kody są prefiksowe (można dekodować bez separatorów).
+    Krok 2 (wariant liniowy): dwie kolejki FIFO.
+    Liście dodajemy do drzewa posortowane rosnąco po częstotliwości (pierwsza kolejka),
+    a nowe węzły wewnętrzne powstają z coraz większymi sumami, więc same układają się
+    w drugą posortowaną kolejkę (w tablicy zaraz za liśćmi). Dwa najmniejsze elementy
+    są zawsze na początkach kolejek – bez kopca, po sortowaniu w czasie O(n).
 */
-static void generateCodes(HuffmanNode* node,
-                          const std::string& prefix,
-                          std::unordered_map<char, std::string>& codes) {
-    if (!node) return;
+template <typename Freq>
+void buildHuffmanTreeTwoQueue(const Freq& freq, HuffmanTree& tree) {
+    const int symbols = static_cast<int>(freq.size());
+    tree.reset(freq.size());
 
-    // Liść = konkretny znak (koniec kodu).
-    if (!node->left && !node->right) {
-        // Specjalny przypadek: jeśli jest tylko 1 symbol, prefix może być pusty.
-        codes[node->ch] = prefix.empty() ? "0" : prefix;
-        return;
+    // Tu 'node' to na razie symbol – liście trafiają do drzewa dopiero po sortowaniu.
+    thread_local std::vector<TreeHeapItem> items;
+    items.clear();
+    for (int c = 0; c < symbols; ++c) {
+        if (freq[c] > 0) items.push_back(TreeHeapItem{freq[c], c});
     }
+    int n = static_cast<int>(items.size());
+    if (n == 0) return;
+
+    // Przy równych częstotliwościach kolejność symboli – wynik nie zależy od implementacji sortowania.
+    std::sort(items.begin(), items.end(), [](const TreeHeapItem& a, const TreeHeapItem& b) {
+        return a.freq != b.freq ? a.freq < b.freq : a.node < b.node;
+    });
+    for (int i = 0; i < n; ++i) tree.addLeaf(items[i].node, items[i].freq);
+
+    int leaf = 0;     // początek kolejki liści
+    int internal = n; // początek kolejki węzłów wewnętrznych
 
-    generateCodes(node->left,  prefix + "0", codes);
-    generateCodes(node->right, prefix + "1", codes);
+    // Mniejszy z początków kolejek (przy remisie liść – płytsze drzewo).
+    auto takeSmallest = [&]() {
+        if (leaf < n && (internal == tree.count || tree.nodes[leaf].freq <= tree.nodes[internal].freq)) {
+            return leaf++;
+        }
+        return internal++;
+    };
+
+    for (int merges = 0; merges < n - 1; ++merges) {
+        int left = takeSmallest();
+        int right = takeSmallest();
+        tree.addInternal(left, right);
+    }
+
+    tree.root = tree.count - 1;
 }
 
 /*
-    Kompresja:
-    - czytamy tekst
-    - budujemy drzewo i słownik kodów
-    - zamieniamy tekst na bity
-    - pakujemy bity do bajtów (uint8_t)
-    - zapisujemy: słownik + dane + bitCount (liczba ważnych bitów)
+    Wybór budowy drzewa: dla kilku symboli kopiec jest tak samo tani jak sortowanie,
+    dla większych alfabetów dwie kolejki wygrywają (mniej porównań, brak przestawiania kopca).
 */
-void compressFile(const std::string& inputFile,
-                  const std::string& outputFile) {
+template <typename Freq>
+void buildHuffmanTree(const Freq& freq, HuffmanTree& tree) {
+    if (usedSymbols(freq) < TWO_QUEUE_MIN_SYMBOLS) {
+        buildHuffmanTreeHeap(freq, tree);
+    } else {
+        buildHuffmanTreeTwoQueue(freq, tree);
+    }
+}
 
-    std::string text = readTextFromFile(inputFile);
+/*
+    Krok 3 (Huffman): długości kodów.
+    Długość kodu znaku = głębokość jego liścia w drzewie. Same kody nadajemy potem
+    kanonicznie (assignCanonicalCodes), więc nie budujemy ich jako napisów.
+    Rodzic leży w tablicy za dziećmi, więc głębokości liczymy jednym przejściem od końca.
+*/
+template <typename Lengths>
+void computeCodeLengths(const HuffmanTree& tree, Lengths& lengths) {
+    if (tree.root < 0) return;
 
-    // Pusty plik: zapisujemy "pustą paczkę" (bez słownika i bez danych).
-    if (text.empty()) {
-        writeCompressedFile(outputFile, {}, {}, 0);
-        std::cout << "Pusty plik – zapisano pusty plik skompresowany\n";
-        return;
+    thread_local std::vector<uint8_t> depth;
+    depth.resize(tree.nodes.size());
+    depth[tree.root] = 0;
+
+    for (int i = tree.root; i >= 0; --i) {
+        const HuffmanNode& node = tree.nodes[i];
+
+        // Liść = konkretny znak (koniec kodu).
+        if (node.left < 0) {
+            // Specjalny przypadek: jeśli jest tylko 1 symbol, korzeń jest liściem -> kod "0".
+            lengths[node.symbol] = static_cast<uint8_t>(depth[i] == 0 ? 1 : depth[i]);
+            continue;
+        }
+
+        depth[node.left]  = static_cast<uint8_t>(depth[i] + 1);
+        depth[node.right] = static_cast<uint8_t>(depth[i] + 1);
+    }
+}
+
+/*
+    Krok 3b: kody o ograniczonej długości (algorytm package-merge).
+    Drzewo Huffmana może być bardzo głębokie (np. częstotliwości jak ciąg Fibonacciego),
+    a koder i dekoder potrzebują kodów mieszczących się w maxLen bitach.
+
+    Idea: każdy symbol to "moneta" o wartości = częstotliwość, dostępna na każdym
+    z maxLen poziomów. Na kolejnym poziomie łączymy sąsiednie pary w "paczki"
+    i scalamy je z monetami (posortowane po wadze). Z ostatniej listy bierzemy
+    2n-2 najtańszych elementów – długość kodu symbolu = ile razy jego moneta
+    znalazła się w wybranych elementach (po rozpakowaniu paczek).
+    Wynik jest optymalny wśród kodów o długości <= maxLen.
+*/
+template <typename Freq, typename Lengths>
+void packageMerge(const Freq& freq, int maxLen, Lengths& lengths) {
+    struct Item {
+        uint64_t weight;
+        int symbol; // >= 0: moneta (liść), -1: paczka
+        int left;
+        int right;
+    };
+
+    std::vector<Item> pool;
+    std::vector<int> coins;
+    const int symbols = static_cast<int>(freq.size());
+    for (int c = 0; c < symbols; ++c) {
+        if (freq[c] > 0) pool.push_back(Item{freq[c], c, -1, -1});
+    }
+    std::sort(pool.begin(), pool.end(), [](const Item& a, const Item& b) {
+        return a.weight != b.weight ? a.weight < b.weight : a.symbol < b.symbol;
+    });
+    for (size_t i = 0; i < pool.size(); ++i) coins.push_back(static_cast<int>(i));
+
+    const size_t n = coins.size();
+    const size_t keep = 2 * n - 2; // tylu elementów potrzebujemy z ostatniej listy
+
+    std::vector<int> current = coins;
+    for (int level = 1; level < maxLen; ++level) {
+        std::vector<int> merged;
+        merged.reserve(keep);
+
+        size_t c = 0; // następna moneta
+        size_t p = 0; // następna para z listy poprzedniego poziomu
+        while (merged.size() < keep && (c < n || p + 1 < current.size())) {
+            uint64_t packageWeight = 0;
+            bool havePackage = p + 1 < current.size();
+            if (havePackage) packageWeight = pool[current[p]].weight + pool[current[p + 1]].weight;
+
+            if (c < n && (!havePackage || pool[coins[c]].weight <= packageWeight)) {
+                merged.push_back(coins[c++]);
+            } else {
+                pool.push_back(Item{packageWeight, -1, current[p], current[p + 1]});
+                merged.push_back(static_cast<int>(pool.size() - 1));
+                p += 2;
+            }
+        }
+
+        current.swap(merged);
     }
 
-    auto freq = countFrequencies(text);
-    HuffmanNode* root = buildHuffmanTree(freq);
+    std::fill(lengths.begin(), lengths.end(), 0);
+    std::vector<int> stack;
+    for (size_t i = 0; i < keep && i < current.size(); ++i) {
+        stack.push_back(current[i]);
+        while (!stack.empty()) {
+            const Item& item = pool[stack.back()];
+            stack.pop_back();
+            if (item.symbol >= 0) {
+                lengths[item.symbol]++;
+            } else {
+                stack.push_back(item.left);
+                stack.push_back(item.right);
+            }
+        }
+    }
+}
+
+// Jawne konkretyzacje dla obu alfabetów (bajty i pary bajtów).
+template void buildHuffmanTreeHeap<Histogram>(const Histogram&, HuffmanTree&);
+template void buildHuffmanTreeHeap<WideHistogram>(const WideHistogram&, HuffmanTree&);
+template void buildHuffmanTreeTwoQueue<Histogram>(const Histogram&, HuffmanTree&);
+template void buildHuffmanTreeTwoQueue<WideHistogram>(const WideHistogram&, HuffmanTree&);
+template void buildHuffmanTree<Histogram>(const Histogram&, HuffmanTree&);
+template void buildHuffmanTree<WideHistogram>(const WideHistogram&, HuffmanTree&);
+template void computeCodeLengths<CodeLengths>(const HuffmanTree&, CodeLengths&);
+template void computeCodeLengths<WideCodeLengths>(const HuffmanTree&, WideCodeLengths&);
+template void packageMerge<Histogram, CodeLengths>(const Histogram&, int, CodeLengths&);
+template void packageMerge<WideHistogram, WideCodeLengths>(const WideHistogram&, int, WideCodeLengths&);
 
-    std::unordered_map<char, std::string> codes;
-    generateCodes(root, "", codes);
+// Łączna liczba bitów danych przy danych długościach kodów.
+template <typename Freq, typename Lengths>
+static uint64_t encodedBits(const Freq& freq, const Lengths& lengths) {
+    uint64_t bits = 0;
+    for (size_t c = 0; c < freq.size(); ++c) bits += freq[c] * lengths[c];
+    return bits;
+}
 
-    // Gdy w pliku jest jeden unikalny znak, wymuszamy kod "0".
-    if (codes.size() == 1) {
-        codes.begin()->second = "0";
+// Kody kanoniczne zapisane jako tekst '0'/'1' (dla starego formatu pliku).
+static std::unordered_map<char, std::string> codesAsText(const std::vector<CodeWord>& codes) {
+    std::unordered_map<char, std::string> text;
+    for (const CodeWord& cw : codes) {
+        std::string bits;
+        for (int b = cw.length - 1; b >= 0; --b) bits += ((cw.code >> b) & 1) ? '1' : '0';
+        text[static_cast<char>(cw.symbol)] = bits;
+    }
+    return text;
+}
+
+/*
+    Długości kodów dla danego rozkładu częstotliwości:
+    drzewo Huffmana, a gdy jest za głębokie – package-merge z limitem maxLen.
+*/
+template <typename Freq, typename Lengths>
+static void buildCodeLengths(const Freq& freq, int maxLen, LengthLimitReport& report, Lengths& lengths) {
+    int symbols = usedSymbols(freq);
+    if (symbols > (1 << maxLen)) {
+        throw std::runtime_error("Limit dlugosci kodu " + std::to_string(maxLen) +
+                                 " bitow jest za maly dla " + std::to_string(symbols) + " symboli");
+    }
+
+    // Drzewo na wątek: tablica węzłów (dla par bajtów – ponad 100 tys.) nie jest alokowana przy każdym bloku.
+    thread_local HuffmanTree tree;
+    buildHuffmanTree(freq, tree);
+
+    std::fill(lengths.begin(), lengths.end(), 0);
+    computeCodeLengths(tree, lengths);
+
+    // Drzewo za głębokie -> przeliczamy długości z limitem i zapamiętujemy stratę.
+    int longest = *std::max_element(lengths.begin(), lengths.end());
+    if (longest > maxLen) {
+        report.unboundedBits += encodedBits(freq, lengths);
+        packageMerge(freq, maxLen, lengths);
+        report.limitedBits += encodedBits(freq, lengths);
+        report.longest = std::max(report.longest, longest);
+    }
+}
+
+static CodeLengths buildCodeLengths(const Histogram& freq, int maxLen, LengthLimitReport& report) {
+    CodeLengths lengths{};
+    buildCodeLengths(freq, maxLen, report, lengths);
+    return lengths;
+}
+
+static void validateOptions(const CompressOptions& options) {
+    if (options.maxCodeLength < 1 || options.maxCodeLength > MAX_CODE_LENGTH) {
+        throw std::runtime_error("Limit dlugosci kodu musi byc w zakresie 1.." + std::to_string(MAX_CODE_LENGTH));
+    }
+    if (options.blockSize == 0 || options.blockSize > MAX_BLOCK_SIZE) {
+        throw std::runtime_error("Rozmiar bloku musi byc w zakresie 1.." + std::to_string(MAX_BLOCK_SIZE) + " bajtow");
+    }
+    if (options.streams < 1 || options.streams > MAX_STREAMS) {
+        throw std::runtime_error("Liczba strumieni musi byc w zakresie 1.." + std::to_string(MAX_STREAMS));
+    }
+    if (options.seekInterval != 0 && options.seekInterval < MIN_SEEK_INTERVAL) {
+        throw std::runtime_error("Odstep punktow dostepu musi wynosic co najmniej " +
+                                 std::to_string(MIN_SEEK_INTERVAL) + " bajtow");
+    }
+    if (options.seekInterval != 0 &&
+        (options.algorithm == ALGORITHM_ADAPTIVE || options.legacyFormat || !options.dictionary.empty())) {
+        throw std::runtime_error("Punkty dostepu (--seek-interval) sa tylko w formacie blokowym");
+    }
+    if (options.checksum &&
+        (options.algorithm == ALGORITHM_ADAPTIVE || options.legacyFormat || !options.dictionary.empty())) {
+        throw std::runtime_error("Sumy kontrolne (--checksum) sa tylko w formacie blokowym");
+    }
+    if (options.symbolBits != 8 && options.symbolBits != 16) {
+        throw std::runtime_error("Szerokosc symbolu musi wynosic 8 albo 16 bitow");
+    }
+    if (options.symbolBits == 16 && (options.algorithm == ALGORITHM_ADAPTIVE || options.legacyFormat ||
+                                     options.sharedTable || options.contextOrder == 1 ||
+                                     !options.dictionary.empty())) {
+        throw std::runtime_error("Symbole 16-bitowe (--symbol-bits=16) nie obsluguja opcji --algorithm=adaptive, "
+                                 "--legacy, --shared-table, --order=1 ani --dict");
+    }
+    if (options.contextOrder != 0 && options.contextOrder != 1) {
+        throw std::runtime_error("Rzad modelu kontekstowego musi byc 0 albo 1");
+    }
+    if (options.contextOrder == 1 &&
+        (options.algorithm == ALGORITHM_ADAPTIVE || options.legacyFormat || options.sharedTable)) {
+        throw std::runtime_error("Model order-1 nie obsluguje opcji --algorithm=adaptive, --legacy ani --shared-table");
+    }
+    if (options.algorithm == ALGORITHM_ADAPTIVE && (options.legacyFormat || options.sharedTable)) {
+        throw std::runtime_error("Tryb adaptacyjny nie obsluguje opcji --legacy ani --shared-table");
+    }
+    if (!options.dictionary.empty() && (options.algorithm == ALGORITHM_ADAPTIVE || options.legacyFormat ||
+                                        options.sharedTable || options.contextOrder == 1)) {
+        throw std::runtime_error("Slownik (--dict) nie obsluguje opcji --algorithm=adaptive, --legacy, "
+                                 "--shared-table ani --order=1");
+    }
+}
+
+/*
+    Stary format: jeden strumień dla całego pliku i słownik z kodami jako tekst.
+    Zwraca rozmiar zapisanego pliku.
+*/
+static uint64_t compressLegacy(const uint8_t* bytes, size_t size, const std::string& outputFile,
+                               const CompressOptions& options, LengthLimitReport& report) {
+    if (size == 0) {
+        return writeCompressedFile(outputFile, {}, {}, 0);
+    }
+
+    ThreadPool pool(options.threads);
+    Histogram freq;
+    {
+        ScopedTimer timer(options.stats, PHASE_HISTOGRAM);
+        freq = countHistogram(bytes, size, pool);
+    }
+    CodeLengths lengths;
+    {
+        ScopedTimer timer(options.stats, PHASE_TREE);
+        lengths = buildCodeLengths(freq, options.maxCodeLength, report);
+    }
+    EncodeTable table;
+    {
+        ScopedTimer timer(options.stats, PHASE_TABLES);
+        table = EncodeTable::fromCodeLengths(lengths);
     }
 
-    // Pakowanie bitów do bajtów:
     std::vector<uint8_t> data;
-    uint8_t currentByte = 0;  // składany bajt
-    int bitPos = 0;           // ile bitów już mamy w currentByte (0..8)
-    uint32_t bitCount = 0;    // ile bitów jest faktycznie zapisanych (bez paddingu)
-
-    for (char c : text) {
-        const std::string& code = codes.at(c);
-
-        for (char b : code) {
-            // Doklejamy kolejny bit do bajtu od lewej strony.
-            currentByte <<= 1;
-            if (b == '1') currentByte |= 1;
-
-            bitPos++;
-            bitCount++;
-
-            // Jeśli mamy pełny bajt -> zapisujemy i zaczynamy nowy.
-            if (bitPos == 8) {
-                data.push_back(currentByte);
-                currentByte = 0;
-                bitPos = 0;
+    uint64_t bits = 0;
+    {
+        ScopedTimer timer(options.stats, PHASE_ENCODE);
+        bits = table.encode(bytes, size, data);
+    }
+    if (options.stats) {
+        options.stats->addCoded(freq, size, bits);
+        options.stats->recordPeak(data.capacity());
+    }
+
+    // bitCount mówi dekoderowi, ile bitów jest "prawdziwych" (reszta ostatniego bajtu to zera).
+    if (bits > UINT32_MAX) {
+        throw std::runtime_error("Plik za duzy dla starego formatu: strumien przekracza 2^32 bitow");
+    }
+
+    ScopedTimer timer(options.stats, PHASE_WRITE);
+    return writeCompressedFile(outputFile, codesAsText(assignCanonicalCodes(lengths)), data,
+                               static_cast<uint32_t>(bits));
+}
+
+/*
+    Rozmiar segmentu bloku: blok dzielimy na 'streams' równych części, ale segment
+    nie bywa mniejszy niż MIN_SEGMENT_SIZE (dla małych bloków narzut tablicy skoków
+    i dopełnień bajtów przeważyłby zysk). 0 = blok z jednym strumieniem.
+    Segment jest też punktem dostępu swobodnego (tablica skoków mówi, gdzie zaczyna się
+    jego strumień), więc z seekInterval segmenty nie są dłuższe niż seekInterval bajtów.
+    Przy parach bajtów (pairs) segment ma parzystą długość – żadna para nie jest rozcięta.
+*/
+static uint32_t segmentSizeFor(size_t size, unsigned streams, uint32_t seekInterval, bool pairs) {
+    size_t segments = std::min<size_t>(streams, size / MIN_SEGMENT_SIZE);
+    size_t segmentSize = segments < 2 ? size : (size + segments - 1) / segments;
+    if (seekInterval != 0) segmentSize = std::min<size_t>(segmentSize, seekInterval);
+    if (pairs && segmentSize < size) segmentSize &= ~size_t(1);
+    return segmentSize < size ? static_cast<uint32_t>(segmentSize) : 0;
+}
+
+static void addReport(LengthLimitReport& total, const LengthLimitReport& part) {
+    total.unboundedBits += part.unboundedBits;
+    total.limitedBits += part.limitedBits;
+    total.longest = std::max(total.longest, part.longest);
+}
+
+/*
+    Model order-1 dla bloku z histogramów kontekstów (liczonych z podziałem na segmenty):
+    grupowanie w najwyżej MAX_CONTEXT_TABLES tablic i długości kodów każdej z nich.
+    Dokładny rozmiar (dane + tablice w nagłówku) porównujemy z jedną tablicą order-0
+    z tych samych częstotliwości ('plain') i zostawiamy mniejszy wariant.
+    Zwraca jego rozmiar w bitach.
+*/
+static uint64_t chooseBlockModel(const std::vector<Histogram>& contexts, const Histogram& plain, int maxLen,
+                                 BlockHeader& header, LengthLimitReport& report) {
+    ContextClusters clusters = clusterContexts(contexts, MAX_CONTEXT_TABLES);
+
+    LengthLimitReport contextReport, plainReport;
+    std::vector<CodeLengths> tables;
+    for (const Histogram& hist : clusters.histograms) tables.push_back(buildCodeLengths(hist, maxLen, contextReport));
+
+    uint64_t contextBits = 0;
+    for (int ctx = 0; ctx < ALPHABET_SIZE; ++ctx) {
+        contextBits += encodedBits(contexts[ctx], tables[clusters.map[ctx]]);
+    }
+    CodeLengths plainLengths = buildCodeLengths(plain, maxLen, plainReport);
+    uint64_t plainBits = encodedBits(plain, plainLengths);
+
+    std::vector<uint8_t> contextTables, plainTable;
+    appendU8(contextTables, static_cast<uint8_t>(tables.size()));
+    appendCodeLengths(contextTables, clusters.map);
+    for (const CodeLengths& lengths : tables) appendCodeLengths(contextTables, lengths);
+    appendCodeLengths(plainTable, plainLengths);
+
+    contextBits += 8 * contextTables.size();
+    plainBits += 8 * plainTable.size();
+    if (contextBits < plainBits) {
+        header.flags |= BLOCK_CONTEXT;
+        header.contextMap = clusters.map;
+        header.contextLengths = std::move(tables);
+        addReport(report, contextReport);
+        return contextBits;
+    }
+    header.flags |= BLOCK_OWN_TABLE;
+    header.lengths = plainLengths;
+    addReport(report, plainReport);
+    return plainBits;
+}
+
+/*
+    --symbol-bits=16: model par bajtów dla bloku. Kody par (z nagłówkiem ich długości
+    i bajtem bez pary) porównujemy z modelem bajtów o rozmiarze 'byteBits' i zostawiamy
+    mniejszy. W tekście częste pary ("e ", "th", "\": ") dostają kody krótsze niż suma
+    kodów ich bajtów, a dla danych bez zależności między sąsiednimi bajtami wygrywa
+    mniejsza tablica bajtów. Gdy różnych par jest więcej niż kodów o długości <= maxLen,
+    zostaje model bajtów. Zwraca rozmiar wybranego modelu w bitach.
+*/
+static uint64_t chooseWideModel(const uint8_t* data, size_t size, int maxLen, uint64_t byteBits,
+                                BlockHeader& header, LengthLimitReport& report, Stats* stats) {
+    if (size < 2) return byteBits;
+
+    thread_local WideHistogram pairs;
+    {
+        ScopedTimer timer(stats, PHASE_HISTOGRAM);
+        countPairHistogram(data, size / 2, pairs);
+    }
+
+    ScopedTimer timer(stats, PHASE_TREE);
+    if (usedSymbols(pairs) > (1 << maxLen)) return byteBits;
+
+    LengthLimitReport wideReport;
+    header.wideLengths.resize(WIDE_ALPHABET_SIZE);
+    buildCodeLengths(pairs, maxLen, wideReport, header.wideLengths);
+    std::vector<uint8_t> table;
+    appendWideCodeLengths(table, header.wideLengths);
+    uint64_t wideBits = encodedBits(pairs, header.wideLengths) + 8 * (table.size() + (size & 1));
+    if (wideBits >= byteBits) return byteBits;
+
+    header.flags = (header.flags & ~BLOCK_OWN_TABLE) | BLOCK_WIDE;
+    header.lastByte = (size & 1) ? data[size - 1] : 0;
+    report = wideReport;
+    return wideBits;
+}
+
+// Jedyny użyty bajt histogramu albo -1, gdy jest ich więcej.
+static int singleSymbol(const Histogram& freq) {
+    int symbol = -1;
+    for (int c = 0; c < ALPHABET_SIZE; ++c) {
+        if (freq[c] == 0) continue;
+        if (symbol >= 0) return -1;
+        symbol = c;
+    }
+    return symbol;
+}
+
+/*
+    Kodowanie jednego bloku (niezależnie od pozostałych – może działać na osobnym wątku):
+    nagłówek bloku (rawSize, flagi, [długości kodów], bitCount) + strumień bitów,
+    a przy kilku strumieniach: rozmiar segmentu, tablica skoków i strumienie po kolei.
+    Bez wspólnej tablicy blok ma własne długości kodów policzone z jego częstotliwości
+    (albo, w trybie order-1, kilka tablic wybieranych przez poprzedni bajt), a zanim
+    cokolwiek zakodujemy, z histogramu wybieramy najtańszy zapis:
+    - jeden powtórzony bajt -> BLOCK_RLE (sam symbol, bez strumienia bitów),
+    - Huffman (dane + tablice + tablica skoków) nie mniejszy niż blok -> BLOCK_RAW
+      (kopia bajtów, np. dla danych już skompresowanych albo losowych),
+    - w pozostałych przypadkach Huffman (z --symbol-bits=16 bajtów albo par bajtów
+      – ten model, który daje mniej bitów).
+    Z options.checksum każdy z tych zapisów dostaje BLOCK_CHECKSUM i CRC32C danych bloku.
+    Nagłówek i wynik ('block') są nadpisywane, ale pamięć ich wektorów jest używana ponownie.
+*/
+static void encodeBlock(const uint8_t* data, size_t size, const CompressOptions& options,
+                        const CodeLengths* shared, BlockHeader& header, LengthLimitReport& report,
+                        std::vector<uint8_t>& block) {
+    header.rawSize = static_cast<uint32_t>(size);
+    header.flags = 0;
+    header.bitCount = 0;
+    header.contextLengths.clear();
+    header.segmentBits.clear();
+
+    Stats* stats = options.stats;
+    const uint8_t checksum = options.checksum ? BLOCK_CHECKSUM : 0;
+    if (checksum) {
+        ScopedTimer timer(stats, PHASE_CHECKSUM);
+        header.flags |= BLOCK_CHECKSUM;
+        header.checksum = crc32c(data, size);
+    }
+
+    header.segmentSize = segmentSizeFor(size, options.streams, options.seekInterval, options.symbolBits == 16);
+    if (header.segmentSize > 0) {
+        header.flags |= BLOCK_SEGMENTS;
+        header.segmentBits.assign(BlockHeader::segmentCount(header.rawSize, header.segmentSize), 0);
+    }
+
+    Histogram freq{};
+    if (shared) {
+        header.lengths = *shared;
+        // Histogram bloku przy wspólnej tablicy liczymy tylko dla entropii w statystykach.
+        if (stats) {
+            ScopedTimer timer(stats, PHASE_HISTOGRAM);
+            freq = countHistogram(data, size);
+        }
+    } else {
+        std::vector<Histogram> contexts;
+        {
+            ScopedTimer timer(stats, PHASE_HISTOGRAM);
+            if (options.contextOrder == 1) {
+                countContextHistograms(data, size, header.segmentSize, contexts);
+                for (const Histogram& hist : contexts) {
+                    for (int c = 0; c < ALPHABET_SIZE; ++c) freq[c] += hist[c];
+                }
+            } else {
+                freq = countHistogram(data, size);
+            }
+        }
+
+        block.clear();
+        int symbol = singleSymbol(freq);
+        if (symbol >= 0) {
+            header.flags = BLOCK_RLE | checksum;
+            header.symbol = static_cast<uint8_t>(symbol);
+            appendBlockHeader(block, header);
+            if (stats) stats->add(stats->rleBlocks, 1);
+            return;
+        }
+
+        // Rozmiar po kodowaniu znamy dokładnie z histogramu (+ dopełnienia strumieni do bajtu).
+        LengthLimitReport blockReport;
+        uint64_t bits = 0;
+        {
+            ScopedTimer timer(stats, PHASE_TREE);
+            if (options.contextOrder == 1) {
+                bits = chooseBlockModel(contexts, freq, options.maxCodeLength, header, blockReport);
+            } else {
+                header.lengths = buildCodeLengths(freq, options.maxCodeLength, blockReport);
+                header.flags |= BLOCK_OWN_TABLE;
+                std::vector<uint8_t> table;
+                appendCodeLengths(table, header.lengths);
+                bits = encodedBits(freq, header.lengths) + 8 * table.size();
             }
         }
+        if (options.symbolBits == 16) {
+            bits = chooseWideModel(data, size, options.maxCodeLength, bits, header, blockReport, stats);
+        }
+        size_t streams = std::max<size_t>(1, header.segmentBits.size());
+        uint64_t huffmanBytes = (bits + 7) / 8 + streams + 4 * streams + 4;
+        if (huffmanBytes >= size) {
+            header.flags = BLOCK_RAW | checksum;
+            appendBlockHeader(block, header);
+            block.insert(block.end(), data, data + size);
+            if (stats) stats->add(stats->rawBlocks, 1);
+            return;
+        }
+        addReport(report, blockReport);
     }
 
-    // Jeśli ostatni bajt jest niepełny, dopchamy zerami do 8 bitów.
-    // bitCount mówi dekoderowi, ile bitów jest "prawdziwych".
-    if (bitPos > 0) {
-        currentByte <<= (8 - bitPos);
-        data.push_back(currentByte);
+    block.clear();
+    size_t bitsPos = appendBlockHeader(block, header);
+
+    // Płaska tablica (kod, długość) indeksowana bajtem (order-1: jedna na grupę kontekstów,
+    // BLOCK_WIDE: parą bajtów) + BitWriter.
+    EncodeTable table;
+    std::vector<EncodeTable> contextTables;
+    thread_local WideEncodeTable wideTable; // 65536 pozycji – jedna na wątek, używana ponownie
+    {
+        ScopedTimer timer(stats, PHASE_TABLES);
+        if (header.flags & BLOCK_WIDE) {
+            wideTable.assign(header.wideLengths);
+        } else if (header.flags & BLOCK_CONTEXT) {
+            for (const CodeLengths& lengths : header.contextLengths) {
+                contextTables.push_back(EncodeTable::fromCodeLengths(lengths));
+            }
+        } else {
+            table = EncodeTable::fromCodeLengths(header.lengths);
+        }
     }
 
-    writeCompressedFile(outputFile, codes, data, bitCount);
+    uint64_t dataBits = 0;
+    auto encodeRange = [&](size_t first, size_t count) {
+        uint64_t bits = 0;
+        if (header.flags & BLOCK_WIDE) {
+            bits = wideTable.encode(data + first, count / 2, block); // bajt bez pary jest w nagłówku
+        } else if (header.flags & BLOCK_CONTEXT) {
+            bits = EncodeTable::encodeWithContext(contextTables, header.contextMap, data + first, count, block);
+        } else {
+            bits = table.encode(data + first, count, block);
+        }
+        dataBits += bits;
+        return static_cast<uint32_t>(bits);
+    };
 
-    std::cout << "OK: kompresja zakonczona\n";
+    {
+        ScopedTimer timer(stats, PHASE_ENCODE);
+        if (header.segmentSize == 0) {
+            patchU32(block, bitsPos, encodeRange(0, size));
+        } else {
+            // Każdy segment to osobny strumień zaczynający się od pełnego bajtu.
+            for (size_t i = 0; i < header.segmentBits.size(); ++i) {
+                size_t first = i * header.segmentSize;
+                size_t count = std::min<size_t>(header.segmentSize, size - first);
+                patchU32(block, bitsPos + 4 * i, encodeRange(first, count));
+            }
+        }
+    }
+    if (stats) {
+        stats->addCoded(freq, size, dataBits);
+        if (header.flags & BLOCK_WIDE) stats->add(stats->wideBlocks, 1);
+    }
 }
 
 /*
-    Dekompresja:
-    - wczytujemy dane, bitCount i słownik (w postaci reverseDict: "101" -> 'a')
-    - czytamy bity po kolei i dokładamy do bufora
-    - gdy bufor tworzy pełny kod, dopisujemy znak i czyścimy bufor
-    - jeśli po końcu zostaje coś w buforze -> dane uszkodzone / ucięte
+    Źródło bloków do kompresji:
+    - plik zmapowany w pamięci albo bufor wywołującego: blok to wskaźnik do wnętrza
+      danych (bez kopiowania); strony już zakodowanych porcji mapowania oddajemy systemowi,
+    - stdin albo brak mmap: bloki czytane do buforów porcji, po jednym na slot.
+    W obu przypadkach pamięć jest ograniczona do porcji bloków będących w potoku.
 */
-void decompressFile(const std::string& inputFile,
-                    const std::string& outputFile) {
+class BlockSource {
+private:
+    std::unique_ptr<MappedFile> mapped;
+    std::unique_ptr<InputStream> stream;
+    std::vector<std::unique_ptr<uint8_t[]>> buffers;
+    const uint8_t* view = nullptr; // dane w pamięci (mapowanie albo bufor wywołującego)
+    size_t viewSize = 0;
+    size_t blockSize;
+    size_t position = 0; // pozycja w danych w pamięci
+    size_t released = 0; // początek stron jeszcze nie oddanych systemowi
 
-    CompressedData cd = readCompressedFile(inputFile);
+public:
+    BlockSource(const std::string& filename, size_t blockSize, size_t slots)
+        : mapped(std::make_unique<MappedFile>(filename)), blockSize(blockSize) {
+        if (mapped->isMapped()) {
+            view = mapped->data();
+            viewSize = mapped->size();
+            return;
+        }
 
-    std::string decoded;
-    std::string buffer;
+        stream = std::make_unique<InputStream>(filename);
+        // Bufory bez zerowania – strony pamięci są zajmowane dopiero przy pierwszym zapisie.
+        buffers.resize(slots);
+        for (auto& buffer : buffers) buffer.reset(new uint8_t[blockSize]);
+    }
+
+    // Dane już w pamięci wywołującego (nic nie jest kopiowane ani alokowane).
+    BlockSource(const uint8_t* data, size_t size, size_t blockSize)
+        : view(data), viewSize(size), blockSize(blockSize) {}
+
+    // Kolejny blok dla slotu 'slot'; zwraca rozmiar (mniej niż blockSize tylko na końcu, 0 = koniec).
+    size_t next(size_t slot, const uint8_t*& data) {
+        if (!stream) {
+            size_t size = std::min(blockSize, viewSize - position);
+            data = view + position;
+            position += size;
+            return size;
+        }
+        data = buffers[slot].get();
+        return stream->read(buffers[slot].get(), blockSize);
+    }
+
+    // Pamięć buforów porcji przy czytaniu ze strumienia (dane w pamięci: 0).
+    size_t bufferBytes() const { return buffers.size() * blockSize; }
+
+    // Pozycja za ostatnim wydanym blokiem (dane w pamięci).
+    size_t consumed() const { return position; }
+
+    /*
+        Czy potok ma co nakładać: wejście z pliku większe niż jedna porcja 'blocks' bloków
+        (strumień: nie wiadomo – zakładamy, że tak). Dla bufora wywołującego nie – odczyt to
+        tylko przesunięcie wskaźnika, więc wątki potoku byłyby samym kosztem.
+    */
+    bool pipelined(size_t blocks) const {
+        return mapped && (stream || viewSize > static_cast<uint64_t>(blocks) * blockSize);
+    }
+
+    // Następne 'bytes' bajtów mapowania system może wczytać w tle, zanim koder po nie sięgnie.
+    void prefetch(size_t bytes) {
+        if (mapped && !stream) mapped->prefetch(position, bytes);
+    }
+
+    // Bloki przed pozycją 'end' (z consumed()) są już zakodowane i zapisane.
+    void done(size_t end) {
+        if (!mapped || stream || end <= released) return;
+        mapped->release(released, end - released);
+        released = end;
+    }
+
+    // Pierwsze przejście dla --shared-table: częstotliwości całego wejścia.
+    Histogram countAll(ThreadPool& pool) {
+        Histogram hist{};
+        if (stream) {
+            if (!stream->seekable()) throw std::runtime_error("Opcja --shared-table wymaga pliku wejsciowego (nie potoku)");
+            size_t got = 0;
+            while ((got = stream->read(buffers[0].get(), blockSize)) > 0) addHistogram(buffers[0].get(), got, hist);
+            stream->rewind();
+        } else {
+            hist = countHistogram(view, viewSize, pool);
+        }
+        return hist;
+    }
+};
+
+// Porcje w obiegu potoku: jedna czytana, jedna przetwarzana, jedna zapisywana.
+static constexpr size_t PIPELINE_DEPTH = 3;
+
+/*
+    Stan kompresji blokowej: pula wątków i PIPELINE_DEPTH porcji (po jednym bloku na wątek).
+    Compressor trzyma go między wywołaniami, więc kolejne kompresje danych
+    podobnej wielkości nie tworzą puli ani nie alokują buforów od nowa.
+*/
+struct BlockEncoderState {
+    struct Batch {
+        size_t count = 0; // liczba bloków w porcji
+        std::vector<const uint8_t*> raw;
+        std::vector<size_t> rawSize;
+        std::vector<BlockHeader> headers;
+        std::vector<std::vector<uint8_t>> blocks;
+        size_t sourceEnd = 0; // BlockSource::consumed() po ostatnim bloku porcji
+    };
+
+    ThreadPool pool;
+    std::vector<Batch> batches;
+    std::vector<LengthLimitReport> reports; // po jednym na blok porcji (koduje tylko jedna porcja naraz)
+    std::vector<BlockIndexEntry> index;
+    std::vector<uint8_t> head; // nagłówek kontenera, a na końcu indeks + stopka
+
+    explicit BlockEncoderState(unsigned threads) : pool(threads), batches(PIPELINE_DEPTH), reports(pool.size()) {
+        for (Batch& batch : batches) {
+            batch.raw.resize(pool.size());
+            batch.rawSize.resize(pool.size());
+            batch.headers.resize(pool.size());
+            batch.blocks.resize(pool.size());
+        }
+    }
+};
+
+/*
+    Kompresja (format blokowy), strumieniowo i ze stałym zużyciem pamięci:
+    - bierzemy wejście porcjami: po jednym bloku (blockSize bajtów) na wątek,
+    - bloki porcji kodujemy równolegle na puli wątków:
+      częstotliwości -> drzewo -> długości kodów -> kody kanoniczne -> BitWriter
+      (albo jedna wspólna tablica kodów dla całego wejścia: --shared-table, dwa przejścia),
+    - zakodowane bloki zapisujemy po kolei; na końcu indeks bloków.
+    Odczyt, kodowanie i zapis to etapy potoku (runPipeline): gdy pula koduje porcję,
+    osobne wątki czytają następną i zapisują poprzednią, więc dysk i procesor pracują
+    jednocześnie. Bufory porcji są używane ponownie, więc pamięć nie rośnie z rozmiarem
+    wejścia (najwyżej PIPELINE_DEPTH porcji naraz).
+*/
+static uint64_t compressBlocks(BlockSource& source, OutputStream& output, const CompressOptions& options,
+                               BlockEncoderState& state, LengthLimitReport& report) {
+    const size_t batchBlocks = state.pool.size();
+    Stats* stats = options.stats;
+    std::fill(state.reports.begin(), state.reports.end(), LengthLimitReport{});
+    state.index.clear();
+
+    ContainerHeader header;
+    header.blockSize = options.blockSize;
+    if (options.checksum) header.flags |= FILE_CHECKSUM;
+    if (options.sharedTable) {
+        Histogram freq;
+        {
+            ScopedTimer timer(stats, PHASE_HISTOGRAM);
+            freq = source.countAll(state.pool);
+        }
+        if (usedSymbols(freq) > 0) {
+            ScopedTimer timer(stats, PHASE_TREE);
+            header.flags |= FILE_SHARED_TABLE;
+            header.sharedLengths = buildCodeLengths(freq, options.maxCodeLength, report);
+        }
+    }
+    const CodeLengths* shared = (header.flags & FILE_SHARED_TABLE) ? &header.sharedLengths : nullptr;
+
+    state.head.clear();
+    appendContainerHeader(state.head, header);
+    output.write(state.head);
+
+    // Stan etapu zapisu (tylko wątek zapisu, aż do końca potoku).
+    uint64_t offset = state.head.size();
+    uint64_t total = 0;
+    uint32_t checksum = 0; // CRC32C całych danych sklejany z sum bloków
+    std::vector<uint64_t> batchBuffers(state.batches.size(), 0); // --stats: pamięć buforów każdej porcji
 
-    for (uint32_t i = 0; i < cd.bitCount; ++i) {
-        // Wyciągamy i-ty bit (czytamy od MSB: 7..0).
-        uint8_t byte = cd.data[i / 8];
-        bool bit = (byte >> (7 - (i % 8))) & 1;
+    auto read = [&](size_t b) {
+        ScopedTimer timer(stats, PHASE_READ);
+        BlockEncoderState::Batch& batch = state.batches[b];
+        batch.count = 0;
+        bool end = false;
+        while (batch.count < batchBlocks && !end) {
+            size_t& size = batch.rawSize[batch.count];
+            size = source.next(b * batchBlocks + batch.count, batch.raw[batch.count]);
+            end = size < options.blockSize;
+            if (size > 0) batch.count++;
+        }
+        batch.sourceEnd = source.consumed();
+        if (!end) source.prefetch(batchBlocks * options.blockSize);
+        return !end;
+    };
+
+    auto encode = [&](size_t b) {
+        BlockEncoderState::Batch& batch = state.batches[b];
+        state.pool.parallelFor(batch.count, [&](size_t i) {
+            encodeBlock(batch.raw[i], batch.rawSize[i], options, shared, batch.headers[i], state.reports[i],
+                        batch.blocks[i]);
+        });
+    };
+
+    auto write = [&](size_t b) {
+        ScopedTimer timer(stats, PHASE_WRITE);
+        const BlockEncoderState::Batch& batch = state.batches[b];
+        for (size_t i = 0; i < batch.count; ++i) {
+            state.index.push_back(BlockIndexEntry{offset, static_cast<uint32_t>(batch.rawSize[i])});
+            output.write(batch.blocks[i]);
+            offset += batch.blocks[i].size();
+            total += batch.rawSize[i];
+            if (options.checksum) checksum = crc32cCombine(checksum, batch.headers[i].checksum, batch.rawSize[i]);
+        }
+        source.done(batch.sourceEnd);
+
+        if (stats) {
+            batchBuffers[b] = 0;
+            for (size_t i = 0; i < batch.count; ++i) batchBuffers[b] += batch.blocks[i].capacity();
+            uint64_t buffers = source.bufferBytes();
+            for (uint64_t bytes : batchBuffers) buffers += bytes;
+            stats->add(stats->blocks, batch.count);
+            stats->recordPeak(buffers);
+        }
+    };
+
+    runPipeline(state.batches.size(), source.pipelined(batchBlocks), read, encode, write);
+
+    {
+        ScopedTimer timer(stats, PHASE_WRITE);
+        state.head.clear();
+        appendBlockIndex(state.head, state.index, offset, options.checksum ? &checksum : nullptr);
+        output.write(state.head);
+        output.close();
+    }
+
+    for (const LengthLimitReport& r : state.reports) addReport(report, r);
+    return total;
+}
+
+// Porcja danych przetwarzana naraz w trybie adaptacyjnym (po niej wynik jest od razu wypychany).
+static constexpr size_t ADAPTIVE_CHUNK = 1u << 16;
 
-        buffer += (bit ? '1' : '0');
+/*
+    Kolejne porcje wejścia dla trybu adaptacyjnego: z danych w pamięci (mapowanie pliku
+    albo bufor wywołującego, od pozycji 'position') albo z potoku – to, co już napłynęło
+    (readSome), bez czekania na pełną porcję.
+*/
+class ChunkSource {
+private:
+    const uint8_t* view;
+    size_t viewSize;
+    MappedFile* mapped; // strony przeczytanych porcji oddajemy systemowi (nullptr = bufor wywołującego)
+    StreamReader* reader;
+    size_t position;
+    size_t released = 0; // początek stron mapowania jeszcze nie oddanych systemowi
+    std::vector<uint8_t> buffer;
 
-        // Ponieważ kody są prefiksowe, gdy buffer pasuje do kodu -> mamy znak.
-        auto it = cd.reverseDict.find(buffer);
-        if (it != cd.reverseDict.end()) {
-            decoded += it->second;
-            buffer.clear();
+public:
+    ChunkSource(const uint8_t* view, size_t viewSize, MappedFile* mapped, StreamReader* reader, size_t position)
+        : view(view), viewSize(viewSize), mapped(mapped), reader(reader), position(position) {
+        if (reader) buffer.resize(ADAPTIVE_CHUNK);
+    }
+
+    // Kolejna porcja (0 = koniec danych).
+    size_t next(const uint8_t*& data) {
+        if (!reader) {
+            size_t size = std::min(ADAPTIVE_CHUNK, viewSize - position);
+            data = view + position;
+            if (mapped) mapped->release(released, position - released);
+            released = position;
+            position += size;
+            return size;
         }
+        data = buffer.data();
+        return reader->readSome(buffer.data(), buffer.size());
     }
+};
 
-    // Jeśli zostały bity, które nie tworzą żadnego kodu -> plik jest niekompletny.
-    if (!buffer.empty()) {
+/*
+    Kompresja adaptacyjna (FGK): jedno przejście, bez nagłówka z kodami.
+    Drzewo zmienia się po każdym symbolu, więc czas na symbol nie zależy od reszty pliku,
+    a po każdej porcji wejścia zakodowane bajty są od razu zapisywane (np. dla logów na żywo).
+    'buffer' to bufor roboczy BitWriter (używany ponownie przez Compressor).
+*/
+static uint64_t compressAdaptive(ChunkSource& source, OutputStream& output, std::vector<uint8_t>& buffer,
+                                 Stats* stats) {
+    std::vector<uint8_t> magic(FORMAT_MAGIC, FORMAT_MAGIC + 3);
+    magic.push_back(FORMAT_ADAPTIVE);
+    output.write(magic);
+
+    // Zapas na kod jednego symbolu i 8 bajtów zapisu BitWriter za końcem.
+    buffer.resize(ADAPTIVE_CHUNK + AdaptiveEncoder::MAX_SYMBOL_BYTES + 8);
+    BitWriter writer(buffer.data());
+    AdaptiveEncoder encoder;
+    uint64_t total = 0;
+    Histogram freq{}; // tylko dla entropii w statystykach
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    while ((size = source.next(data)) > 0) {
+        if (stats) addHistogram(data, size, freq);
+        {
+            ScopedTimer timer(stats, PHASE_ENCODE);
+            for (size_t i = 0; i < size; ++i) {
+                encoder.encode(data[i], writer);
+                if (writer.bitsSince(buffer.data()) >= ADAPTIVE_CHUNK * 8) {
+                    output.write(buffer.data(), writer.rewind(buffer.data()));
+                }
+            }
+        }
+        total += size;
+
+        ScopedTimer timer(stats, PHASE_WRITE);
+        output.write(buffer.data(), writer.rewind(buffer.data()));
+        output.flush();
+    }
+    if (stats) stats->recordPeak(buffer.capacity());
+
+    encoder.finish(writer);
+    uint8_t* end = writer.finish();
+    output.write(buffer.data(), static_cast<size_t>(end - buffer.data()));
+    output.close();
+    if (stats) stats->addCoded(freq, total, 8 * (output.written() - 4));
+    return total;
+}
+
+// Dekompresja adaptacyjna: porcje wejścia -> dekoder (stan między porcjami) -> od razu na wyjście.
+static void decompressAdaptive(ChunkSource& source, OutputStream& output, Stats* stats) {
+    AdaptiveDecoder decoder;
+    std::vector<uint8_t> decoded;
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    while (!decoder.finished() && (size = source.next(data)) > 0) {
+        {
+            ScopedTimer timer(stats, PHASE_DECODE);
+            decoder.feed(data, size, decoded);
+        }
+        if (stats) {
+            stats->add(stats->symbols, decoded.size());
+            stats->add(stats->codedBits, 8 * size);
+        }
+        ScopedTimer timer(stats, PHASE_WRITE);
+        output.write(decoded);
+        output.flush();
+        if (stats) stats->recordPeak(decoded.capacity());
+        decoded.clear();
+    }
+
+    if (!decoder.finished()) throw std::runtime_error("Uszkodzony plik: nieoczekiwany koniec danych");
+    output.close();
+}
+
+// ID słownika w komunikatach (szesnastkowo, jak wypisuje je polecenie train).
+static std::string dictionaryName(uint32_t id) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%08x", id);
+    return text;
+}
+
+/*
+    Kompresja ze słownikiem: nagłówek z ID słownika i jeden strumień kodowany
+    gotową tablicą – bez zliczania, budowy drzewa i długości kodów w pliku.
+    'buffer' to bufor roboczy (używany ponownie przez Compressor).
+*/
+static uint64_t compressWithDictionary(const uint8_t* data, size_t size, const Dictionary& dictionary,
+                                       OutputStream& output, std::vector<uint8_t>& buffer, Stats* stats) {
+    if (size > UINT32_MAX) throw std::runtime_error("Dane za duze dla formatu slownikowego (najwyzej 4 GB)");
+
+    buffer.assign(FORMAT_MAGIC, FORMAT_MAGIC + 3);
+    appendU8(buffer, FORMAT_DICTIONARY);
+    appendU32(buffer, dictionary.id);
+    appendU32(buffer, static_cast<uint32_t>(size));
+    appendU32(buffer, 0); // bitCount – poprawiany po zakodowaniu
+
+    uint64_t bits = 0;
+    {
+        ScopedTimer timer(stats, PHASE_ENCODE);
+        bits = dictionary.encoder.encode(data, size, buffer);
+    }
+    if (bits > UINT32_MAX) {
+        throw std::runtime_error("Strumien przekracza 2^32 bitow – dla tak duzych danych uzyj formatu blokowego");
+    }
+    patchU32(buffer, DICTIONARY_HEADER_SIZE - 4, static_cast<uint32_t>(bits));
+    if (stats) {
+        stats->addCoded(countHistogram(data, size), size, bits);
+        stats->recordPeak(buffer.capacity());
+    }
+
+    ScopedTimer timer(stats, PHASE_WRITE);
+    output.write(buffer);
+    output.close();
+    return size;
+}
+
+/*
+    Rozmiar danych i liczba bitów z nagłówka formatu słownikowego ('in' stoi za identyfikatorem słownika).
+    Każdy symbol zajmuje co najmniej bit, więc rozmiar większy od liczby bitów albo bity nie mieszczące
+    się w pliku to uszkodzony nagłówek – sprawdzamy to przed rezerwacją bufora na rawSize bajtów.
+*/
+static uint32_t readDictionarySizes(ByteReader& in, uint32_t& bitCount) {
+    uint32_t rawSize = in.u32();
+    bitCount = in.u32();
+    if (rawSize > bitCount || bitCount > static_cast<uint64_t>(in.remaining()) * 8) {
         throw std::runtime_error("Niepelne dane – nie mozna w pelni zdekodowac pliku");
     }
+    if (in.remaining() > (static_cast<size_t>(bitCount) + 7) / 8) {
+        throw std::runtime_error("Uszkodzony plik: nadmiarowe dane");
+    }
+    return rawSize;
+}
+
+// Dekompresja formatu słownikowego (dane w pamięci); 'decoded' to bufor roboczy.
+static void decompressWithDictionary(const uint8_t* data, size_t size, const Dictionary* dictionary,
+                                     OutputStream& output, std::vector<uint8_t>& decoded, Stats* stats) {
+    ByteReader in(data, size, 4);
+    uint32_t id = in.u32();
+    if (!dictionary) {
+        throw std::runtime_error("Plik skompresowany ze slownikiem " + dictionaryName(id) + " – podaj --dict=PLIK");
+    }
+    if (id != dictionary->id) {
+        throw std::runtime_error("Plik wymaga slownika " + dictionaryName(id) + ", podano slownik " +
+                                 dictionaryName(dictionary->id));
+    }
+
+    uint32_t bitCount = 0;
+    uint32_t rawSize = readDictionarySizes(in, bitCount);
+
+    decoded.resize(rawSize);
+    DecodeTable::Stream stream{data + in.position(), in.remaining(), bitCount, decoded.data(), rawSize};
+    {
+        ScopedTimer timer(stats, PHASE_DECODE);
+        dictionary->decoder.decodeStreams(&stream, 1);
+    }
+    if (stats) {
+        stats->add(stats->symbols, rawSize);
+        stats->add(stats->codedBits, bitCount);
+        stats->recordPeak(decoded.capacity());
+    }
+
+    ScopedTimer timer(stats, PHASE_WRITE);
+    output.write(decoded);
+    output.close();
+}
+
+CompressStats compressFile(const std::string& inputFile,
+                           const std::string& outputFile,
+                           const CompressOptions& options) {
+
+    validateOptions(options);
 
-    writeTextToFile(outputFile, decoded);
-    std::cout << "OK: dekompresja zakonczona\n";
+    ScopedTimer timer(options.stats, PHASE_TOTAL);
+    CompressStats stats;
+
+    if (!options.dictionary.empty()) {
+        // Format słownikowy jest dla małych wiadomości: cały plik naraz (z mapowania albo wczytany).
+        std::shared_ptr<const Dictionary> dictionary = loadDictionary(options.dictionary);
+        MappedFile mapped(inputFile);
+        std::vector<uint8_t> bytes, buffer;
+        if (!mapped.isMapped()) {
+            ScopedTimer readTimer(options.stats, PHASE_READ);
+            bytes = readBinaryFile(inputFile);
+        }
+        OutputStream output(outputFile);
+        stats.inputBytes =
+            mapped.isMapped()
+                ? compressWithDictionary(mapped.data(), mapped.size(), *dictionary, output, buffer, options.stats)
+                : compressWithDictionary(bytes.data(), bytes.size(), *dictionary, output, buffer, options.stats);
+        stats.outputBytes = output.written();
+    } else if (options.legacyFormat) {
+        // Stary format ma jeden strumień na cały plik: koduje cały widok pliku
+        // (albo cały tekst ze stdin, gdy mapowanie nie jest możliwe).
+        MappedFile mapped(inputFile);
+        if (mapped.isMapped()) {
+            stats.outputBytes = compressLegacy(mapped.data(), mapped.size(), outputFile, options, stats.lengthLimit);
+            stats.inputBytes = mapped.size();
+        } else {
+            std::string text;
+            {
+                ScopedTimer readTimer(options.stats, PHASE_READ);
+                text = readTextFromFile(inputFile);
+            }
+            stats.outputBytes = compressLegacy(reinterpret_cast<const uint8_t*>(text.data()), text.size(), outputFile,
+                                               options, stats.lengthLimit);
+            stats.inputBytes = text.size();
+        }
+    } else if (options.algorithm == ALGORITHM_ADAPTIVE) {
+        MappedFile mapped(inputFile);
+        std::unique_ptr<InputStream> input;
+        std::unique_ptr<StreamReader> reader;
+        if (!mapped.isMapped()) {
+            input = std::make_unique<InputStream>(inputFile);
+            reader = std::make_unique<StreamReader>(input->get());
+        }
+        ChunkSource source(mapped.data(), mapped.size(), &mapped, reader.get(), 0);
+        OutputStream output(outputFile);
+        std::vector<uint8_t> buffer;
+        stats.inputBytes = compressAdaptive(source, output, buffer, options.stats);
+        stats.outputBytes = output.written();
+    } else {
+        OutputStream output(outputFile);
+        BlockEncoderState state(options.threads);
+        BlockSource source(inputFile, options.blockSize, PIPELINE_DEPTH * state.pool.size());
+        stats.inputBytes = compressBlocks(source, output, options, state, stats.lengthLimit);
+        stats.outputBytes = output.written();
+    }
+
+    if (options.stats) {
+        options.stats->add(options.stats->inputBytes, stats.inputBytes);
+        options.stats->add(options.stats->outputBytes, stats.outputBytes);
+    }
+    return stats;
+}
+
+// Dane bloku: z pamięci bez kopiowania, ze strumienia – do bufora slotu.
+static const uint8_t* blockPayload(ByteReader& reader, size_t size, std::vector<uint8_t>&) {
+    return reader.bytes(size);
 }
 
-/* DEMO KOPCA (MinHeap)
-   - buildFromArray (heapify)
-   - insert
-   - decreaseKey
-   - extractMin w pętli (sortowanie rosnąco po priorytecie)
+static const uint8_t* blockPayload(StreamReader& reader, size_t size, std::vector<uint8_t>& buffer) {
+    buffer.resize(size);
+    reader.read(buffer.data(), size);
+    return buffer.data();
+}
+
+/*
+    Stan dekompresji blokowej: pula wątków i sloty PIPELINE_DEPTH porcji (po jednym
+    na wątek w porcji; porcja b to sloty [b * pool.size(), (b + 1) * pool.size())).
+    Slot trzyma nagłówek, dane i wynik bloku oraz tablice dekodujące i opisy strumieni –
+    Decompressor używa ich ponownie, więc kolejne wywołania nie alokują pamięci.
 */
-struct DemoItem {
-    std::string name;
-    int priority;
+struct BlockDecoderState {
+    struct Slot {
+        BlockHeader block;
+        const uint8_t* data = nullptr;     // strumień bitów bloku
+        std::vector<uint8_t> buffer;       // kopia strumienia bitów (tylko przy czytaniu ze strumienia)
+        std::vector<uint8_t> decoded;      // odtworzone bajty
+        std::vector<DecodeTable> tables;   // własna tablica bloku albo tablice order-1
+        std::vector<DecodeTable::Stream> streams;
+        size_t begin = 0, end = 0;         // dostęp swobodny: potrzebne bajty bloku
+    };
+
+    ThreadPool pool;
+    std::vector<Slot> slots;
+    std::vector<size_t> counts;         // liczba bloków w każdej porcji
+    std::vector<uint64_t> readEnd;      // pozycja czytnika za ostatnim blokiem porcji
+    std::vector<BlockIndexEntry> seen;  // bloki przeczytane po kolei
+    std::vector<BlockIndexEntry> index; // indeks z końca pliku
+    DecodeTable sharedTable;
+    Stats* stats; // pomiary (nullptr = bez)
+
+    BlockDecoderState(unsigned threads, Stats* stats)
+        : pool(threads), slots(PIPELINE_DEPTH * pool.size()), counts(PIPELINE_DEPTH), readEnd(PIPELINE_DEPTH),
+          stats(stats) {}
 };
 
-static bool lessDemoItem(const DemoItem& a, const DemoItem& b) {
-    return a.priority < b.priority;
+/*
+    Dekodowanie danych bloku ze slotu do 'out' (miejsce na rawSize bajtów). Segmenty dostają
+    swoje fragmenty danych według tablicy skoków i są dekodowane naprzemiennie.
+    Dekodowane są tylko segmenty obejmujące bajty [begin, end) bloku (dostęp swobodny);
+    blok z jednym strumieniem zawsze w całości.
+    Czytnik strumienia może sięgać za jego koniec (do końca bloku) – to tylko
+    pozwala na szybkie 8-bajtowe odczyty; zgodność bitCount i tak jest sprawdzana.
+*/
+static void decodeBlockData(const DecodeTable& sharedTable, BlockDecoderState::Slot& slot, uint8_t* out,
+                            Stats* stats, size_t begin, size_t end) {
+    const BlockHeader& block = slot.block;
+    if (block.flags & BLOCK_RLE) {
+        std::memset(out + begin, block.symbol, end - begin);
+        return;
+    }
+
+    // BLOCK_WIDE: strumienie kodują pary (count = połowa bajtów), a bajt bez pary jest w nagłówku.
+    const bool wide = (block.flags & BLOCK_WIDE) != 0;
+    const size_t symbolBytes = wide ? 2 : 1;
+    if (wide && (block.rawSize & 1)) out[block.rawSize - 1] = block.lastByte;
+
+    const size_t size = block.dataSize();
+    std::vector<DecodeTable::Stream>& streams = slot.streams;
+    streams.clear();
+    if (!(block.flags & BLOCK_SEGMENTS)) {
+        streams.push_back(DecodeTable::Stream{slot.data, size, block.bitCount, out, block.rawSize / symbolBytes});
+    } else {
+        size_t offset = 0;
+        for (size_t i = 0; i < block.segmentBits.size(); ++i) {
+            size_t first = i * static_cast<size_t>(block.segmentSize);
+            size_t count = std::min<size_t>(block.segmentSize, block.rawSize - first);
+            if (first < end && first + count > begin) {
+                streams.push_back(DecodeTable::Stream{slot.data + offset, size - offset, block.segmentBits[i],
+                                                      out + first, count / symbolBytes});
+            }
+            offset += (static_cast<size_t>(block.segmentBits[i]) + 7) / 8;
+        }
+    }
+
+    // Tablic slotu nie zmniejszamy – ich pamięć przyda się przy następnych blokach.
+    size_t tables = (block.flags & BLOCK_CONTEXT) ? block.contextLengths.size() : 1;
+    if (slot.tables.size() < tables) slot.tables.resize(tables);
+    {
+        ScopedTimer timer(stats, PHASE_TABLES);
+        if (wide) {
+            slot.tables[0].assign(block.wideLengths);
+        } else if (block.flags & BLOCK_CONTEXT) {
+            for (size_t t = 0; t < tables; ++t) slot.tables[t].assign(block.contextLengths[t]);
+        } else if (block.flags & BLOCK_OWN_TABLE) {
+            slot.tables[0].assign(block.lengths);
+        }
+    }
+
+    {
+        ScopedTimer timer(stats, PHASE_DECODE);
+        if (wide) {
+            slot.tables[0].decodeWideStreams(streams.data(), streams.size());
+        } else if (block.flags & BLOCK_CONTEXT) {
+            DecodeTable::decodeStreams(slot.tables.data(), tables, block.contextMap, streams.data(), streams.size());
+        } else if (block.flags & BLOCK_OWN_TABLE) {
+            slot.tables[0].decodeStreams(streams.data(), streams.size());
+        } else {
+            sharedTable.decodeStreams(streams.data(), streams.size());
+        }
+    }
+
+    if (stats) {
+        uint64_t symbols = 0, bits = 0;
+        for (const DecodeTable::Stream& stream : streams) {
+            symbols += stream.count * symbolBytes; // w bajtach, jak przy kompresji
+            bits += stream.bitCount;
+        }
+        stats->add(stats->symbols, symbols);
+        stats->add(stats->codedBits, bits);
+    }
+}
+
+// Liczniki --stats dla porcji zdekodowanych bloków (rodzaje bloków i pamięć buforów slotów).
+static void countDecodedBlocks(Stats* stats, const BlockDecoderState::Slot* slots, size_t count) {
+    if (!stats) return;
+    uint64_t raw = 0, rle = 0, wide = 0, buffers = 0;
+    for (size_t i = 0; i < count; ++i) {
+        raw += (slots[i].block.flags & BLOCK_RAW) != 0;
+        rle += (slots[i].block.flags & BLOCK_RLE) != 0;
+        wide += (slots[i].block.flags & BLOCK_WIDE) != 0;
+        buffers += slots[i].decoded.capacity() + slots[i].buffer.capacity();
+    }
+    stats->add(stats->blocks, count);
+    stats->add(stats->rawBlocks, raw);
+    stats->add(stats->rleBlocks, rle);
+    stats->add(stats->wideBlocks, wide);
+    stats->recordPeak(buffers);
+}
+
+/*
+    BLOCK_CHECKSUM: CRC32C odtworzonych bajtów bloku (BLOCK_RAW – prosto z wejścia)
+    musi zgadzać się z zapisanym. Liczone na wątku bloku, zaraz po dekodowaniu,
+    kiedy dane są jeszcze w pamięci podręcznej – bez osobnego przejścia po wyniku.
+*/
+static void verifyBlockChecksum(const BlockDecoderState::Slot& slot, Stats* stats) {
+    if (!(slot.block.flags & BLOCK_CHECKSUM)) return;
+    ScopedTimer timer(stats, PHASE_CHECKSUM);
+    const uint8_t* bytes = (slot.block.flags & BLOCK_RAW) ? slot.data : slot.decoded.data();
+    if (crc32c(bytes, slot.block.rawSize) != slot.block.checksum) {
+        throw std::runtime_error("Uszkodzony plik: suma kontrolna bloku nie zgadza sie");
+    }
+}
+
+/*
+    Nagłówek i dane kolejnego bloku do slotu (z kontrolą rozmiaru, tablicy kodów
+    i sumy kontrolnej); false = znacznik końca bloków.
+*/
+template <typename Reader>
+static bool readBlockSlot(Reader& reader, const ContainerHeader& header, BlockDecoderState::Slot& slot) {
+    readBlockHeader(reader, slot.block);
+    if (slot.block.rawSize == 0) return false;
+    if (slot.block.rawSize > header.blockSize) throw std::runtime_error("Uszkodzony plik: za duzy blok");
+    const uint8_t ownData = BLOCK_OWN_TABLE | BLOCK_CONTEXT | BLOCK_WIDE | BLOCK_RAW | BLOCK_RLE;
+    if (!(slot.block.flags & ownData) && !(header.flags & FILE_SHARED_TABLE)) {
+        throw std::runtime_error("Uszkodzony plik: blok bez tablicy kodow");
+    }
+    if (((slot.block.flags & BLOCK_CHECKSUM) != 0) != ((header.flags & FILE_CHECKSUM) != 0)) {
+        throw std::runtime_error("Uszkodzony plik: blok bez sumy kontrolnej");
+    }
+    slot.data = blockPayload(reader, slot.block.dataSize(), slot.buffer);
+    return true;
+}
+
+/*
+    Czy uruchamiać wątki potoku: plik zajmuje więcej niż jedną porcję (ze strumienia nie wiadomo –
+    zakładamy, że tak). Dane wywołującego w pamięci (mapped == nullptr) dekodujemy bez nich –
+    nie ma tam odczytu ani zapisu, który mógłby nakładać się z dekodowaniem.
+*/
+static bool largeInput(const ByteReader& reader, const MappedFile* mapped, uint64_t batchBytes) {
+    return mapped && reader.remaining() > batchBytes;
 }
 
-void runHeapDemo() {
-    std::cout << "=== HEAP DEMO ===\n";
+static bool largeInput(const StreamReader&, const MappedFile*, uint64_t) {
+    return true;
+}
+
+/*
+    Dekompresja formatu blokowego, strumieniowo, jako potok (runPipeline):
+    - wątek odczytu czyta po kolei nagłówki i dane bloków, porcjami po jednym bloku na wątek,
+    - bloki porcji dekodujemy równolegle do buforów wyjściowych (używanych ponownie),
+    - wątek zapisu od razu zapisuje wynik, więc pamięć nie zależy od rozmiaru pliku,
+      a odczyt, dekodowanie i zapis kolejnych porcji nakładają się w czasie,
+    - przy FILE_CHECKSUM każdy wątek sprawdza sumę swojego bloku, a z sum bloków
+      (po kolei, bez ponownego czytania danych) składamy sumę całości,
+    - na końcu sprawdzamy, czy indeks bloków zgadza się z tym, co przeczytaliśmy.
+*/
+template <typename Reader>
+static uint64_t decompressBlocks(Reader& reader, OutputStream& output, BlockDecoderState& state,
+                                 MappedFile* mapped) {
+    Stats* stats = state.stats;
+    ContainerHeader header;
+    {
+        ScopedTimer timer(stats, PHASE_READ);
+        header = readContainerHeader(reader);
+    }
+    if (header.flags & FILE_SHARED_TABLE) {
+        ScopedTimer timer(stats, PHASE_TABLES);
+        state.sharedTable.assign(header.sharedLengths);
+    }
+
+    const size_t batchBlocks = state.pool.size();
+    state.seen.clear();
+    uint32_t storedChecksum = 0; // etap odczytu: suma z końca bloków
+    uint64_t total = 0;          // etap zapisu
+    uint32_t checksum = 0;
+    size_t released = 0; // początek stron mapowania jeszcze nie oddanych systemowi
+
+    auto read = [&](size_t b) {
+        ScopedTimer timer(stats, PHASE_READ);
+        BlockDecoderState::Slot* slots = &state.slots[b * batchBlocks];
+        uint64_t start = reader.position();
+        size_t& count = state.counts[b];
+        count = 0;
+        bool end = false;
+        while (count < batchBlocks) {
+            uint64_t offset = reader.position();
+            if (!readBlockSlot(reader, header, slots[count])) {
+                end = true;
+                break;
+            }
+            state.seen.push_back(BlockIndexEntry{offset, slots[count].block.rawSize});
+            count++;
+        }
+        state.readEnd[b] = reader.position();
+        if (mapped) mapped->prefetch(static_cast<size_t>(start), static_cast<size_t>(state.readEnd[b] - start));
+
+        if (end) {
+            if (header.flags & FILE_CHECKSUM) storedChecksum = reader.u32();
+            readTrailingIndex(reader, state.index);
+        }
+        return !end;
+    };
+
+    // Bloki BLOCK_RAW nie wymagają dekodowania – zapisujemy je prosto z wejścia.
+    auto decode = [&](size_t b) {
+        BlockDecoderState::Slot* slots = &state.slots[b * batchBlocks];
+        state.pool.parallelFor(state.counts[b], [&](size_t i) {
+            BlockDecoderState::Slot& slot = slots[i];
+            if (!(slot.block.flags & BLOCK_RAW)) {
+                slot.decoded.resize(slot.block.rawSize);
+                decodeBlockData(state.sharedTable, slot, slot.decoded.data(), stats, 0, slot.block.rawSize);
+            }
+            verifyBlockChecksum(slot, stats);
+        });
+    };
 
-    DemoItem items[] = {
-        {"A", 5},
-        {"B", 2},
-        {"C", 8},
-        {"D", 1},
-        {"E", 3}
+    auto write = [&](size_t b) {
+        ScopedTimer timer(stats, PHASE_WRITE);
+        const BlockDecoderState::Slot* slots = &state.slots[b * batchBlocks];
+        for (size_t i = 0; i < state.counts[b]; ++i) {
+            const BlockDecoderState::Slot& slot = slots[i];
+            if (slot.block.flags & BLOCK_RAW) {
+                output.write(slot.data, slot.block.rawSize);
+            } else {
+                output.write(slot.decoded);
+            }
+            total += slot.block.rawSize;
+            if (header.flags & FILE_CHECKSUM) {
+                checksum = crc32cCombine(checksum, slot.block.checksum, slot.block.rawSize);
+            }
+        }
+        countDecodedBlocks(stats, slots, state.counts[b]);
+        if (mapped) {
+            size_t position = static_cast<size_t>(state.readEnd[b]);
+            mapped->release(released, position - released);
+            released = position;
+        }
     };
 
-    MinHeap<DemoItem> heap(10, lessDemoItem);
-    heap.buildFromArray(items, 5);
+    const bool pipelined = largeInput(reader, mapped, static_cast<uint64_t>(batchBlocks) * header.blockSize);
+    runPipeline(PIPELINE_DEPTH, pipelined, read, decode, write);
 
-    std::cout << "[BUILD FROM ARRAY]\n";
-    heap.debugPrint([](const DemoItem& x) {
-        std::cout << x.name << "(" << x.priority << ") ";
-    });
-    std::cout << "\n";
+    if ((header.flags & FILE_CHECKSUM) && storedChecksum != checksum) {
+        throw std::runtime_error("Uszkodzony plik: suma kontrolna pliku nie zgadza sie");
+    }
+    bool same = state.index.size() == state.seen.size();
+    for (size_t i = 0; same && i < state.index.size(); ++i) {
+        same = state.index[i].offset == state.seen[i].offset && state.index[i].rawSize == state.seen[i].rawSize;
+    }
+    if (!same) throw std::runtime_error("Uszkodzony plik: blok nie zgadza sie z indeksem");
+
+    output.close();
+    return total;
+}
+
+/*
+    Dostęp swobodny w formacie blokowym (dane w pamięci): z indeksu na końcu pliku
+    wybieramy bloki obejmujące [offset, offset + length), czytamy tylko je (od pozycji
+    z indeksu) i dekodujemy w nich tylko segmenty obejmujące zakres – porcjami po
+    jednym bloku na wątek. Bloki z sumą kontrolną dekodujemy w całości, żeby ją
+    sprawdzić (sumy całego pliku nie – wymagałaby wszystkich bloków).
+    Zwraca liczbę zapisanych bajtów.
+*/
+static uint64_t decompressBlockRange(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                                     OutputStream& output, BlockDecoderState& state) {
+    Stats* stats = state.stats;
+    ScopedTimer totalTimer(stats, PHASE_TOTAL);
+
+    ContainerHeader header;
+    {
+        ScopedTimer timer(stats, PHASE_READ);
+        ByteReader reader(data, size);
+        header = readContainerHeader(reader);
+        state.index = readBlockIndex(data, size);
+    }
+    if (header.flags & FILE_SHARED_TABLE) {
+        ScopedTimer timer(stats, PHASE_TABLES);
+        state.sharedTable.assign(header.sharedLengths);
+    }
+
+    // Pierwszy blok zakresu: pozycja bloku w danych to suma rawSize bloków przed nim.
+    const std::vector<BlockIndexEntry>& index = state.index;
+    size_t next = 0;
+    uint64_t blockStart = 0;
+    while (next < index.size() && blockStart + index[next].rawSize <= offset) {
+        blockStart += index[next++].rawSize;
+    }
+    if (next == index.size() && offset > blockStart) {
+        throw std::runtime_error("Przesuniecie " + std::to_string(offset) + " poza koncem danych (" +
+                                 std::to_string(blockStart) + " B)");
+    }
+    const uint64_t end = offset + std::min(length, UINT64_MAX - offset);
+
+    std::vector<BlockDecoderState::Slot>& slots = state.slots;
+    uint64_t written = 0, read = 0;
+    while (next < index.size() && blockStart < end) {
+        size_t count = 0;
+        {
+            ScopedTimer timer(stats, PHASE_READ);
+            while (count < state.pool.size() && next < index.size() && blockStart < end) {
+                const BlockIndexEntry& entry = index[next++];
+                if (entry.offset >= size) {
+                    throw std::runtime_error("Uszkodzony plik: blok nie zgadza sie z indeksem");
+                }
+                ByteReader reader(data, size, static_cast<size_t>(entry.offset));
+                BlockDecoderState::Slot& slot = slots[count++];
+                if (!readBlockSlot(reader, header, slot) || slot.block.rawSize != entry.rawSize) {
+                    throw std::runtime_error("Uszkodzony plik: blok nie zgadza sie z indeksem");
+                }
+                slot.begin = offset > blockStart ? static_cast<size_t>(offset - blockStart) : 0;
+                slot.end = static_cast<size_t>(std::min<uint64_t>(entry.rawSize, end - blockStart));
+                blockStart += entry.rawSize;
+                read += reader.position() - entry.offset;
+            }
+        }
+
+        state.pool.parallelFor(count, [&](size_t i) {
+            BlockDecoderState::Slot& slot = slots[i];
+            bool whole = (slot.block.flags & BLOCK_CHECKSUM) != 0;
+            if (!(slot.block.flags & BLOCK_RAW)) {
+                slot.decoded.resize(slot.block.rawSize);
+                decodeBlockData(state.sharedTable, slot, slot.decoded.data(), stats, whole ? 0 : slot.begin,
+                                whole ? slot.block.rawSize : slot.end);
+            }
+            verifyBlockChecksum(slot, stats);
+        });
+
+        ScopedTimer timer(stats, PHASE_WRITE);
+        for (size_t i = 0; i < count; ++i) {
+            const BlockDecoderState::Slot& slot = slots[i];
+            const uint8_t* bytes = (slot.block.flags & BLOCK_RAW) ? slot.data : slot.decoded.data();
+            output.write(bytes + slot.begin, slot.end - slot.begin);
+            written += slot.end - slot.begin;
+        }
+        countDecodedBlocks(stats, slots.data(), count);
+    }
+
+    output.close();
+    if (stats) {
+        stats->add(stats->inputBytes, read);
+        stats->add(stats->outputBytes, written);
+    }
+    return written;
+}
+
+/*
+    Formaty jednostrumieniowe: kody (same długości albo słownik "101" -> 'a')
+    -> tablica dekodująca (DecodeTable) -> jeden odczyt z tablicy na znak.
+    Jeśli ostatni kod nie mieści się w bitCount -> dane uszkodzone / ucięte.
+*/
+static void decompressSingleStream(const CompressedData& cd, OutputStream& output, Stats* stats) {
+    DecodeTable table;
+    {
+        ScopedTimer timer(stats, PHASE_TABLES);
+        table = cd.canonical ? DecodeTable::fromCodeLengths(cd.codeLengths)
+                             : DecodeTable::fromDictionary(cd.reverseDict);
+    }
+    std::string decoded;
+    {
+        ScopedTimer timer(stats, PHASE_DECODE);
+        table.decode(cd.data.data(), cd.data.size(), cd.bitCount, decoded);
+    }
+    if (stats) {
+        stats->add(stats->symbols, decoded.size());
+        stats->add(stats->codedBits, cd.bitCount);
+        stats->recordPeak(decoded.capacity() + cd.data.capacity());
+    }
+
+    ScopedTimer timer(stats, PHASE_WRITE);
+    output.write(reinterpret_cast<const uint8_t*>(decoded.data()), decoded.size());
+    output.close();
+}
+
+/*
+    Dekompresja:
+    - rozpoznajemy format po sygnaturze (z mapowania albo podglądając pierwsze bajty stdin)
+    - format blokowy: strumieniowo, bloki porcjami równolegle (decompressBlocks)
+    - format adaptacyjny: porcjami, wynik wypychany po każdej porcji (decompressAdaptive)
+    - formaty jednostrumieniowe: w całości (decompressSingleStream)
+*/
+uint64_t decompressFile(const std::string& inputFile,
+                        const std::string& outputFile,
+                        const DecompressOptions& options) {
+
+    Stats* stats = options.stats;
+    ScopedTimer timer(stats, PHASE_TOTAL);
+
+    // Plik zmapowany w pamięci czytamy bez kopiowania, stdin – strumieniowo.
+    MappedFile mapped(inputFile);
+    std::unique_ptr<InputStream> input;
+    std::unique_ptr<StreamReader> stream;
+    const uint8_t* magic = mapped.data();
+    size_t magicSize = mapped.size();
+
+    if (!mapped.isMapped()) {
+        input = std::make_unique<InputStream>(inputFile);
+        stream = std::make_unique<StreamReader>(input->get());
+        magicSize = stream->peek(4, magic);
+    }
+
+    OutputStream output(outputFile);
+    uint8_t format = detectFormat(magic, magicSize);
+    if (format == FORMAT_ADAPTIVE) {
+        // Za sygnaturą od razu strumień bitów.
+        if (stream) stream->bytes(4);
+        ChunkSource source(mapped.data(), mapped.size(), &mapped, stream.get(), 4);
+        decompressAdaptive(source, output, stats);
+    } else if (format == FORMAT_DICTIONARY) {
+        std::shared_ptr<const Dictionary> dictionary;
+        if (!options.dictionary.empty()) dictionary = loadDictionary(options.dictionary);
+        std::vector<uint8_t> bytes, decoded;
+        if (!mapped.isMapped()) {
+            ScopedTimer readTimer(stats, PHASE_READ);
+            bytes = stream->readToEnd();
+        }
+        if (mapped.isMapped()) {
+            decompressWithDictionary(mapped.data(), mapped.size(), dictionary.get(), output, decoded, stats);
+        } else {
+            decompressWithDictionary(bytes.data(), bytes.size(), dictionary.get(), output, decoded, stats);
+        }
+    } else if (format == FORMAT_BLOCKS) {
+        BlockDecoderState state(options.threads, stats);
+        if (mapped.isMapped()) {
+            ByteReader reader(mapped.data(), mapped.size());
+            decompressBlocks(reader, output, state, &mapped);
+        } else {
+            decompressBlocks(*stream, output, state, nullptr);
+        }
+    } else {
+        std::vector<uint8_t> bytes;
+        CompressedData cd;
+        {
+            ScopedTimer readTimer(stats, PHASE_READ);
+            if (!mapped.isMapped()) bytes = stream->readToEnd();
+            cd = mapped.isMapped() ? parseCompressedData(mapped.data(), mapped.size())
+                                   : parseCompressedData(bytes.data(), bytes.size());
+        }
+        decompressSingleStream(cd, output, stats);
+    }
+
+    if (stats) {
+        stats->add(stats->inputBytes, mapped.isMapped() ? mapped.size() : stream->position());
+        stats->add(stats->outputBytes, output.written());
+    }
+    return output.written();
+}
+
+/* API w pamięci */
+
+struct Compressor::State {
+    BlockEncoderState blocks;
+    std::vector<uint8_t> buffer; // bufor roboczy trybu adaptacyjnego i słownikowego
+    std::shared_ptr<const Dictionary> dictionary;
+
+    explicit State(unsigned threads) : blocks(threads) {}
+};
+
+Compressor::Compressor(const CompressOptions& options) : options(options) {
+    validateOptions(options);
+    if (options.legacyFormat) throw std::runtime_error("Stary format (--legacy) jest dostepny tylko dla plikow");
+    state = std::make_unique<State>(options.threads);
+    if (!options.dictionary.empty()) state->dictionary = loadDictionary(options.dictionary);
+}
+
+Compressor::~Compressor() = default;
+Compressor::Compressor(Compressor&&) noexcept = default;
+Compressor& Compressor::operator=(Compressor&&) noexcept = default;
+
+CompressStats Compressor::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    ScopedTimer timer(options.stats, PHASE_TOTAL);
+    out.clear();
+    OutputStream output(out);
+    CompressStats stats;
+
+    if (state->dictionary) {
+        stats.inputBytes =
+            compressWithDictionary(data, size, *state->dictionary, output, state->buffer, options.stats);
+    } else if (options.algorithm == ALGORITHM_ADAPTIVE) {
+        ChunkSource source(data, size, nullptr, nullptr, 0);
+        stats.inputBytes = compressAdaptive(source, output, state->buffer, options.stats);
+    } else {
+        BlockSource source(data, size, options.blockSize);
+        stats.inputBytes = compressBlocks(source, output, options, state->blocks, stats.lengthLimit);
+    }
+
+    stats.outputBytes = output.written();
+    if (options.stats) {
+        options.stats->add(options.stats->inputBytes, stats.inputBytes);
+        options.stats->add(options.stats->outputBytes, stats.outputBytes);
+    }
+    return stats;
+}
+
+std::vector<uint8_t> Compressor::compress(const uint8_t* data, size_t size) {
+    std::vector<uint8_t> out;
+    compress(data, size, out);
+    return out;
+}
+
+// Dekompresja danych w pamięci (każdy format) do podanego wyjścia; 'scratch' – bufor roboczy.
+static void decompressMemory(const uint8_t* data, size_t size, OutputStream& output, BlockDecoderState& state,
+                             const Dictionary* dictionary, std::vector<uint8_t>& scratch) {
+    Stats* stats = state.stats;
+    ScopedTimer timer(stats, PHASE_TOTAL);
+
+    uint8_t format = detectFormat(data, size);
+    if (format == FORMAT_DICTIONARY) {
+        decompressWithDictionary(data, size, dictionary, output, scratch, stats);
+    } else if (format == FORMAT_ADAPTIVE) {
+        ChunkSource source(data, size, nullptr, nullptr, 4);
+        decompressAdaptive(source, output, stats);
+    } else if (format == FORMAT_BLOCKS) {
+        ByteReader reader(data, size);
+        decompressBlocks(reader, output, state, nullptr);
+    } else {
+        decompressSingleStream(parseCompressedData(data, size), output, stats);
+    }
+
+    if (stats) {
+        stats->add(stats->inputBytes, size);
+        stats->add(stats->outputBytes, output.written());
+    }
+}
 
-    std::cout << "\n[INSERT] X(4)\n";
-    heap.insert({"X", 4});
+/*
+    Zakres [offset, offset + length) danych w pamięci: format blokowy przez indeks
+    (decompressBlockRange), pozostałe formaty nie mają punktów dostępu – dekodujemy
+    całość do 'scratch' i wycinamy zakres.
+*/
+static uint64_t decompressRangeMemory(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                                      OutputStream& output, BlockDecoderState& state, const Dictionary* dictionary,
+                                      std::vector<uint8_t>& scratch) {
+    if (detectFormat(data, size) == FORMAT_BLOCKS) {
+        return decompressBlockRange(data, size, offset, length, output, state);
+    }
+
+    std::vector<uint8_t> decoded;
+    OutputStream whole(decoded);
+    decompressMemory(data, size, whole, state, dictionary, scratch);
+    if (offset > decoded.size()) {
+        throw std::runtime_error("Przesuniecie " + std::to_string(offset) + " poza koncem danych (" +
+                                 std::to_string(decoded.size()) + " B)");
+    }
+    size_t count = static_cast<size_t>(std::min<uint64_t>(length, decoded.size() - offset));
+    output.write(decoded.data() + offset, count);
+    output.close();
+    return count;
+}
 
-    if (heap.getSize() > 1) {
-        std::cout << "\n[DECREASE KEY] index=1, 4 -> 0\n";
-        heap.decreaseKey(1, {"Z", 0});
+uint64_t extractFile(const std::string& inputFile, uint64_t offset, uint64_t length,
+                     const std::string& outputFile, const DecompressOptions& options) {
+    // Bez mapowania (stdin, system bez mmap) wczytujemy całość – dekodowany jest i tak tylko zakres.
+    MappedFile mapped(inputFile);
+    std::vector<uint8_t> bytes;
+    if (!mapped.isMapped()) {
+        ScopedTimer timer(options.stats, PHASE_READ);
+        InputStream input(inputFile);
+        bytes = StreamReader(input.get()).readToEnd();
     }
+    const uint8_t* data = mapped.isMapped() ? mapped.data() : bytes.data();
+    size_t size = mapped.isMapped() ? mapped.size() : bytes.size();
+
+    std::shared_ptr<const Dictionary> dictionary;
+    if (!options.dictionary.empty()) dictionary = loadDictionary(options.dictionary);
+    BlockDecoderState state(options.threads, options.stats);
+    std::vector<uint8_t> scratch;
+    OutputStream output(outputFile);
+    return decompressRangeMemory(data, size, offset, length, output, state, dictionary.get(), scratch);
+}
+
+struct Decompressor::State {
+    BlockDecoderState blocks;
+    std::vector<uint8_t> decoded; // wynik formatu słownikowego przed zapisem
+    std::shared_ptr<const Dictionary> dictionary;
+
+    State(unsigned threads, Stats* stats) : blocks(threads, stats) {}
+};
+
+Decompressor::Decompressor(const DecompressOptions& options)
+    : state(std::make_unique<State>(options.threads, options.stats)) {
+    if (!options.dictionary.empty()) state->dictionary = loadDictionary(options.dictionary);
+}
+
+Decompressor::~Decompressor() = default;
+Decompressor::Decompressor(Decompressor&&) noexcept = default;
+Decompressor& Decompressor::operator=(Decompressor&&) noexcept = default;
+
+size_t Decompressor::decompress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity) {
+    OutputStream output(out, capacity);
+    decompressMemory(data, size, output, state->blocks, state->dictionary.get(), state->decoded);
+    return static_cast<size_t>(output.written());
+}
 
-    std::cout << "\n[EXTRACT MIN]\n";
-    while (!heap.isEmpty()) {
-        DemoItem m = heap.extractMin();
-        std::cout << m.name << "(" << m.priority << ")\n";
+uint64_t Decompressor::decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    OutputStream output(out);
+    decompressMemory(data, size, output, state->blocks, state->dictionary.get(), state->decoded);
+    return output.written();
+}
+
+uint64_t Decompressor::decompressRange(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                                       std::vector<uint8_t>& out) {
+    out.clear();
+    OutputStream output(out);
+    return decompressRangeMemory(data, size, offset, length, output, state->blocks, state->dictionary.get(),
+                                 state->decoded);
+}
+
+uint64_t Decompressor::decompressedSize(const uint8_t* data, size_t size) {
+    uint8_t format = detectFormat(data, size);
+    if (format == FORMAT_DICTIONARY) {
+        ByteReader in(data, size, 8);
+        uint32_t bitCount = 0;
+        return readDictionarySizes(in, bitCount);
+    }
+    if (format != FORMAT_BLOCKS) {
+        throw std::runtime_error("Rozmiar po dekompresji jest zapisany tylko w formacie blokowym i slownikowym");
     }
+    uint64_t total = 0;
+    for (const BlockIndexEntry& e : readBlockIndex(data, size)) total += e.rawSize;
+    return total;
+}
 
-    std::cout << "\n[ISEMPTY] -> " << (heap.isEmpty() ? "true" : "false") << "\n";
-}
\ No newline at end of file
+std::vector<uint8_t> compressBuffer(const uint8_t* data, size_t size, const CompressOptions& options) {
+    return Compressor(options).compress(data, size);
+}
+
+std::vector<uint8_t> decompressBuffer(const uint8_t* data, size_t size, const DecompressOptions& options) {
+    std::vector<uint8_t> out;
+    Decompressor(options).decompress(data, size, out);
+    return out;
+}
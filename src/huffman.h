@@ -1,37 +1,210 @@
 #ifndef HUFFMAN_H
 #define HUFFMAN_H
 
+#include "canonical.h"
+#include "format.h"
+#include "histogram.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+
+struct Stats;
+
+// Drzewo dla n symboli ma n liści i n - 1 węzłów wewnętrznych.
+constexpr int MAX_TREE_NODES = 2 * ALPHABET_SIZE - 1;
 
 /*
-  Węzeł drzewa Huffmana:
-  - liść: przechowuje znak (ch) i jego częstotliwość (freq)
-  - węzeł wewnętrzny: ch = '\0', freq = suma freq dzieci
+  Węzeł drzewa Huffmana (w tablicy HuffmanTree, dzieci wskazywane indeksami):
+  - liść: symbol i jego częstotliwość, left = right = -1
+  - węzeł wewnętrzny: freq = suma freq dzieci
 */
 struct HuffmanNode {
-    char ch;            // znak (sensowny tylko dla liści)
-    int freq;           // częstotliwość znaku / suma częstotliwości w poddrzewie
-    HuffmanNode* left;  // dziecko lewe (0)
-    HuffmanNode* right; // dziecko prawe (1)
+    uint64_t freq;  // częstotliwość znaku / suma częstotliwości w poddrzewie
+    int32_t left;   // indeks dziecka lewego (0), -1 dla liścia
+    int32_t right;  // indeks dziecka prawego (1), -1 dla liścia
+    uint16_t symbol; // znak albo para bajtów (sensowny tylko dla liści)
+};
 
-    // Konstruktor liścia: reprezentuje pojedynczy znak.
-    HuffmanNode(char c, int f)
-        : ch(c), freq(f), left(nullptr), right(nullptr) {}
+/*
+  Drzewo Huffmana w jednej tablicy (bez new/delete dla każdego węzła).
+  Węzły dokładamy po kolei, a rodzic zawsze powstaje po swoich dzieciach,
+  więc przejście od końca tablicy odwiedza rodziców przed dziećmi.
+  Tablica ma miejsce na drzewo alfabetu bajtów; drzewo par bajtów (65536 symboli)
+  powiększa ją przy pierwszej budowie, a kolejne budowy używają tej samej pamięci.
+*/
+struct HuffmanTree {
+    std::vector<HuffmanNode> nodes = std::vector<HuffmanNode>(MAX_TREE_NODES);
+    int count = 0; // liczba użytych węzłów
+    int root = -1; // -1 = puste drzewo
 
-    // Konstruktor węzła wewnętrznego: łączy dwa poddrzewa.
-    HuffmanNode(HuffmanNode* l, HuffmanNode* r)
-        : ch('\0'), freq(l->freq + r->freq), left(l), right(r) {}
+    // Czyści drzewo i zapewnia miejsce na drzewo 'symbols' symboli.
+    void reset(size_t symbols) {
+        if (nodes.size() < 2 * symbols - 1) nodes.resize(2 * symbols - 1);
+        count = 0;
+        root = -1;
+    }
+
+    int addLeaf(int symbol, uint64_t freq) {
+        nodes[count] = HuffmanNode{freq, -1, -1, static_cast<uint16_t>(symbol)};
+        return count++;
+    }
+
+    int addInternal(int left, int right) {
+        nodes[count] = HuffmanNode{nodes[left].freq + nodes[right].freq, left, right, 0};
+        return count++;
+    }
 };
 
-// Kompresuje plik tekstowy do formatu Huffmana (słownik + dane + bitCount).
-void compressFile(const std::string& inputFile,
-                  const std::string& outputFile);
+// Od tylu symboli drzewo budujemy dwiema kolejkami zamiast kopcem (por. huffman-bench).
+constexpr int TWO_QUEUE_MIN_SYMBOLS = 12;
+
+/*
+  Budowa drzewa Huffmana z histogramu: kopcem, dwiema kolejkami albo z automatycznym wyborem.
+  Funkcje drzewa i długości kodów działają dla obu alfabetów: bajtów (Histogram, CodeLengths)
+  i par bajtów (WideHistogram, WideCodeLengths) – rozmiar alfabetu to rozmiar histogramu.
+*/
+template <typename Freq>
+void buildHuffmanTreeHeap(const Freq& freq, HuffmanTree& tree);
+template <typename Freq>
+void buildHuffmanTreeTwoQueue(const Freq& freq, HuffmanTree& tree);
+template <typename Freq>
+void buildHuffmanTree(const Freq& freq, HuffmanTree& tree);
 
-// Dekompresuje plik zapisany w formacie Huffmana do tekstu.
-void decompressFile(const std::string& inputFile,
-                    const std::string& outputFile);
+// Długości kodów = głębokości liści drzewa (jedyny symbol dostaje długość 1).
+template <typename Lengths>
+void computeCodeLengths(const HuffmanTree& tree, Lengths& lengths);
+
+// Optymalne długości kodów nie dłuższych niż maxLen (package-merge).
+template <typename Freq, typename Lengths>
+void packageMerge(const Freq& freq, int maxLen, Lengths& lengths);
+
+// Algorytm kompresji.
+enum CompressAlgorithm {
+    ALGORITHM_STATIC,  // kody z częstotliwości (dwa etapy: zliczanie, kodowanie) – format blokowy
+    ALGORITHM_ADAPTIVE // adaptacyjny Huffman (FGK): jedno przejście, bez nagłówka
+};
+
+// Liczba niezależnych strumieni w bloku (dekodowanych naprzemiennie) i najmniejszy segment.
+constexpr unsigned DEFAULT_STREAMS = 4;
+constexpr unsigned MAX_STREAMS = 256;
+constexpr size_t MIN_SEGMENT_SIZE = 4096;
+
+// Ustawienia kompresji (domyślnie format kanoniczny).
+struct CompressOptions {
+    CompressAlgorithm algorithm = ALGORITHM_STATIC;
+    bool legacyFormat = false; // stary format: słownik z kodami zapisanymi jako tekst '0'/'1'
+    int maxCodeLength = DEFAULT_MAX_CODE_LENGTH; // limit długości kodu (1..MAX_CODE_LENGTH)
+    uint32_t blockSize = DEFAULT_BLOCK_SIZE;     // rozmiar bloku formatu blokowego (bajty)
+    bool sharedTable = false;                    // jedna tablica kodów dla wszystkich bloków
+    unsigned streams = DEFAULT_STREAMS;          // strumieni na blok (1 = jeden strumień)
+    uint32_t seekInterval = 0;                   // segment najwyżej co tyle bajtów (0 = tylko 'streams')
+    int contextOrder = 0;                        // 1 = tablice kodów zależne od poprzedniego bajtu
+    bool checksum = false;                       // CRC32C bloków i całych danych (sprawdzane przy dekodowaniu)
+    int symbolBits = 8;                          // 16 = bloki mogą kodować pary bajtów (alfabet 65536 symboli)
+    unsigned threads = 0;                        // liczba wątków (0 = liczba rdzeni)
+    std::string dictionary;                      // plik słownika (format słownikowy); pusty = bez
+    Stats* stats = nullptr;                      // pomiary faz i liczniki (stats.h); nullptr = bez
+};
+
+// Ustawienia dekompresji.
+struct DecompressOptions {
+    unsigned threads = 0;   // liczba wątków (0 = liczba rdzeni)
+    std::string dictionary; // plik słownika dla plików w formacie słownikowym
+    Stats* stats = nullptr; // pomiary faz i liczniki (stats.h); nullptr = bez
+};
+
+// Ile kosztował limit długości kodów (sumowane po wszystkich tablicach kodów).
+struct LengthLimitReport {
+    uint64_t unboundedBits = 0; // bity danych przy kodach Huffmana bez limitu
+    uint64_t limitedBits = 0;   // bity danych przy kodach z limitem
+    int longest = 0;            // najdłuższy kod bez limitu (0 = limit nie był potrzebny)
+};
+
+// Wynik kompresji (biblioteka nic nie wypisuje – komunikaty należą do wywołującego).
+struct CompressStats {
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    LengthLimitReport lengthLimit;
+};
+
+// Kompresuje plik do formatu blokowego (albo starego formatu z --legacy).
+CompressStats compressFile(const std::string& inputFile,
+                           const std::string& outputFile,
+                           const CompressOptions& options = {});
+
+// Dekompresuje plik zapisany w formacie Huffmana; zwraca liczbę odtworzonych bajtów.
+uint64_t decompressFile(const std::string& inputFile,
+                        const std::string& outputFile,
+                        const DecompressOptions& options = {});
+
+/*
+  Dostęp swobodny: zapisuje bajty [offset, offset + length) odtworzonych danych
+  i zwraca ich liczbę. Zakres wychodzący za koniec danych jest przycinany (offset równy
+  rozmiarowi daje 0 bajtów), a offset za końcem danych to błąd. W formacie blokowym
+  indeks wskazuje bloki, a tablica skoków segmenty obejmujące zakres – dekodowane są
+  tylko one (gęstsze punkty dostępu daje --seek-interval). Pozostałe formaty
+  dekodujemy w całości.
+*/
+uint64_t extractFile(const std::string& inputFile, uint64_t offset, uint64_t length,
+                     const std::string& outputFile, const DecompressOptions& options = {});
+
+/*
+  Kompresja danych w pamięci (ten sam format co compressFile, bez --legacy).
+  Ze słownikiem (options.dictionary) wiadomość ma tylko 16 bajtów nagłówka, a tablice
+  kodów są wczytane raz – to najszybsza droga dla wielu małych wiadomości.
+  Obiekt trzyma pulę wątków i bufory bloków, więc kolejne wywołania dla danych
+  podobnej wielkości nie tworzą wątków i nie alokują buforów danych od nowa.
+  Jeden obiekt nie może być używany z kilku wątków naraz.
+*/
+class Compressor {
+public:
+    explicit Compressor(const CompressOptions& options = {});
+    ~Compressor();
+    Compressor(Compressor&&) noexcept;
+    Compressor& operator=(Compressor&&) noexcept;
+
+    // Wynik zastępuje zawartość 'out' (jego pamięć jest używana ponownie).
+    CompressStats compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    std::vector<uint8_t> compress(const uint8_t* data, size_t size);
+
+private:
+    struct State;
+    CompressOptions options;
+    std::unique_ptr<State> state;
+};
+
+// Dekompresja danych w pamięci (każdy format); stan używany ponownie jak w Compressor.
+class Decompressor {
+public:
+    explicit Decompressor(const DecompressOptions& options = {});
+    ~Decompressor();
+    Decompressor(Decompressor&&) noexcept;
+    Decompressor& operator=(Decompressor&&) noexcept;
+
+    // Do bufora wywołującego; zwraca liczbę bajtów (za mały bufor -> wyjątek).
+    size_t decompress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity);
+
+    // Wynik zastępuje zawartość 'out' (jego pamięć jest używana ponownie).
+    uint64_t decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    // Tylko bajty [offset, offset + length) danych (jak extractFile); wynik zastępuje 'out'.
+    uint64_t decompressRange(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                             std::vector<uint8_t>& out);
+
+    // Rozmiar po dekompresji z nagłówka (format blokowy i słownikowy) – np. do przygotowania bufora.
+    static uint64_t decompressedSize(const uint8_t* data, size_t size);
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
 
-// Krótka demonstracja działania MinHeap (nie jest częścią Huffmana).
-void runHeapDemo();
+// Jednorazowe wywołania (tworzą Compressor/Decompressor na czas jednej operacji).
+std::vector<uint8_t> compressBuffer(const uint8_t* data, size_t size, const CompressOptions& options = {});
+std::vector<uint8_t> decompressBuffer(const uint8_t* data, size_t size, const DecompressOptions& options = {});
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,182 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+  IndexedMinHeap – kopiec minimalny z adresowaniem elementów przez uchwyty.
+
+  W zwykłym MinHeap indeks elementu zmienia się przy każdym insert/extractMin,
+  więc nie da się później zmienić jego priorytetu. Tutaj insert zwraca uchwyt
+  (Handle), który pozostaje ważny, dopóki element jest w kopcu:
+  - values[h]   – wartość elementu o uchwycie h,
+  - heap[i]     – uchwyt elementu na pozycji i kopca (d-arnego, jak w MinHeap),
+  - position[h] – gdzie w kopcu jest element h (NONE = uchwyt wolny),
+  a każde przestawienie w kopcu aktualizuje position, więc decreaseKey,
+  increaseKey i erase po uchwycie działają w O(log n).
+  Uchwyty usuniętych elementów są używane ponownie przez kolejne insert.
+*/
+template <typename T, typename Compare = bool (*)(const T&, const T&), size_t Arity = 2>
+class IndexedMinHeap {
+    static_assert(Arity >= 2, "Kopiec musi miec co najmniej 2 dzieci na wezel");
+
+public:
+    using Handle = size_t;
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    std::vector<T> values;
+    std::vector<Handle> heap;
+    std::vector<size_t> position;
+    std::vector<Handle> freeHandles;
+    Compare less;
+
+    void place(size_t index, Handle h) {
+        heap[index] = h;
+        position[h] = index;
+    }
+
+    void heapifyUp(size_t index) {
+        Handle h = heap[index];
+        while (index > 0) {
+            size_t parent = (index - 1) / Arity;
+            if (!less(values[h], values[heap[parent]])) break;
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, h);
+    }
+
+    void heapifyDown(size_t index) {
+        const size_t size = heap.size();
+        Handle h = heap[index];
+        while (true) {
+            size_t first = Arity * index + 1;
+            if (first >= size) break;
+
+            size_t last = first + Arity < size ? first + Arity : size;
+            size_t smallest = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (less(values[heap[child]], values[heap[smallest]])) smallest = child;
+            }
+
+            if (!less(values[heap[smallest]], values[h])) break;
+
+            place(index, heap[smallest]);
+            index = smallest;
+        }
+        place(index, h);
+    }
+
+    void checkHandle(Handle h) const {
+        if (!contains(h)) throw std::runtime_error("Invalid heap handle");
+    }
+
+    // Usuwa element z pozycji 'index' (ostatni element trafia na jego miejsce).
+    void removeAt(size_t index) {
+        Handle removed = heap[index];
+        Handle last = heap.back();
+        heap.pop_back();
+        position[removed] = NONE;
+        freeHandles.push_back(removed);
+
+        if (index < heap.size()) {
+            place(index, last);
+            heapifyUp(index);
+            heapifyDown(position[last]);
+        }
+    }
+
+public:
+    explicit IndexedMinHeap(Compare cmp = Compare()) : less(std::move(cmp)) {}
+
+    [[nodiscard]] bool isEmpty() const { return heap.empty(); }
+    [[nodiscard]] size_t getSize() const { return heap.size(); }
+
+    // Czy uchwyt wskazuje element, który wciąż jest w kopcu.
+    [[nodiscard]] bool contains(Handle h) const { return h < position.size() && position[h] != NONE; }
+
+    // Wstawia element i zwraca jego uchwyt (O(log n)).
+    Handle insert(T value) {
+        Handle h;
+        if (!freeHandles.empty()) {
+            h = freeHandles.back();
+            freeHandles.pop_back();
+            values[h] = std::move(value);
+        } else {
+            h = values.size();
+            values.push_back(std::move(value));
+            position.push_back(NONE);
+        }
+
+        heap.push_back(h);
+        place(heap.size() - 1, h);
+        heapifyUp(heap.size() - 1);
+        return h;
+    }
+
+    [[nodiscard]] const T& get(Handle h) const {
+        checkHandle(h);
+        return values[h];
+    }
+
+    // Uchwyt i wartość elementu minimalnego (bez usuwania).
+    [[nodiscard]] Handle minHandle() const {
+        if (isEmpty()) throw std::runtime_error("Heap is empty");
+        return heap[0];
+    }
+
+    [[nodiscard]] const T& peekMin() const { return values[minHandle()]; }
+
+    // Zwraca i usuwa element minimalny; jego uchwyt przestaje być ważny.
+    T extractMin() {
+        Handle h = minHandle();
+        T min = std::move(values[h]);
+        removeAt(0);
+        return min;
+    }
+
+    // Nowa wartość o wyższym priorytecie (mniejsza) – element idzie w górę.
+    void decreaseKey(Handle h, T newValue) {
+        checkHandle(h);
+        if (less(values[h], newValue))
+            throw std::runtime_error("New value does not decrease priority");
+
+        values[h] = std::move(newValue);
+        heapifyUp(position[h]);
+    }
+
+    // Nowa wartość o niższym priorytecie (większa) – element idzie w dół.
+    void increaseKey(Handle h, T newValue) {
+        checkHandle(h);
+        if (less(newValue, values[h]))
+            throw std::runtime_error("New value does not increase priority");
+
+        values[h] = std::move(newValue);
+        heapifyDown(position[h]);
+    }
+
+    // Dowolna zmiana wartości (kierunek wybierany automatycznie).
+    void update(Handle h, T newValue) {
+        checkHandle(h);
+        bool up = less(newValue, values[h]);
+        values[h] = std::move(newValue);
+        if (up) {
+            heapifyUp(position[h]);
+        } else {
+            heapifyDown(position[h]);
+        }
+    }
+
+    // Usuwa element o danym uchwycie (O(log n)).
+    void erase(Handle h) {
+        checkHandle(h);
+        removeAt(position[h]);
+    }
+};
+
+#endif
@@ -2,43 +2,213 @@
 
 #include <fstream>
 #include <stdexcept>
-#include <iterator>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
-std::string readTextFromFile(const std::string& filename) {
-    // Czytamy cały plik 1:1 jako bajty (tryb binary = brak konwersji końców linii).
-    std::ifstream file(filename, std::ios::binary);
+#if defined(__unix__) || defined(__APPLE__)
+#define HUFFMAN_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+// Nie dołączamy <io.h> – nazwa koliduje z naszym io.h.
+extern "C" int _setmode(int fd, int mode);
+#endif
+
+bool isStdStream(const std::string& filename) {
+    return filename == "-";
+}
+
+// Na Windows stdin/stdout domyślnie zamieniają "\n" na "\r\n" – dla danych binarnych wyłączamy to.
+static void setBinaryMode(std::FILE* f) {
+#ifdef _WIN32
+    _setmode(_fileno(f), _O_BINARY);
+#else
+    (void)f;
+#endif
+}
+
+InputStream::InputStream(const std::string& filename) : stream(&file), name(filename) {
+    if (isStdStream(filename)) {
+        setBinaryMode(stdin);
+        // cin jest domyślnie związany z cout: każdy odczyt opróżnia cout. W potoku odczyt i zapis
+        // działają na różnych wątkach, więc takie opróżnianie to wyścig z zapisem wyniku na stdout.
+        std::cin.tie(nullptr);
+        stream = &std::cin;
+        return;
+    }
+
+    file.open(filename, std::ios::binary);
     if (!file) {
         throw std::runtime_error("Nie mozna otworzyc pliku wejsciowego: " + filename);
     }
+}
 
-    return std::string(
-        (std::istreambuf_iterator<char>(file)),
-        std::istreambuf_iterator<char>()
-    );
+size_t InputStream::read(uint8_t* dst, size_t n) {
+    stream->read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
+    if (stream->bad()) throw std::runtime_error("Blad odczytu pliku: " + name);
+    return static_cast<size_t>(stream->gcount());
 }
 
-void writeTextToFile(const std::string& filename, const std::string& text) {
-    // Zapisujemy dokładnie tyle bajtów, ile ma tekst (bez żadnych modyfikacji).
-    std::ofstream file(filename, std::ios::binary);
+void InputStream::rewind() {
+    if (!seekable()) throw std::runtime_error("Nie mozna przewinac standardowego wejscia");
+    file.clear();
+    file.seekg(0);
+}
+
+OutputStream::OutputStream(const std::string& filename) : stream(&file), name(filename) {
+    if (isStdStream(filename)) {
+        setBinaryMode(stdout);
+        stream = &std::cout;
+        return;
+    }
+
+    file.open(filename, std::ios::binary);
     if (!file) {
-        throw std::runtime_error("Nie mozna zapisac pliku: " + filename);
+        throw std::runtime_error("Nie mozna otworzyc pliku wyjsciowego: " + filename);
+    }
+}
+
+void OutputStream::write(const uint8_t* data, size_t size) {
+    if (vector) {
+        vector->insert(vector->end(), data, data + size);
+    } else if (!stream) {
+        if (size > capacity - count) throw std::runtime_error("Bufor wyjsciowy jest za maly");
+        if (size > 0) std::memcpy(fixed + count, data, size);
+    } else {
+        stream->write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!*stream) throw std::runtime_error("Blad zapisu pliku: " + name);
     }
+    count += size;
+}
 
-    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+void OutputStream::flush() {
+    if (!stream) return;
+    stream->flush();
+    if (!*stream) throw std::runtime_error("Blad zapisu pliku: " + name);
 }
 
-void writeCompressedFile(const std::string& filename,
-                         const std::unordered_map<char, std::string>& codes,
-                         const std::vector<uint8_t>& data,
-                         uint32_t bitCount) {
+void OutputStream::close() {
+    flush();
+}
 
-    std::ofstream file(filename, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Nie mozna otworzyc pliku wyjsciowego: " + filename);
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef HUFFMAN_HAVE_MMAP
+    if (isStdStream(filename)) return;
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Nie mozna otworzyc pliku wejsciowego: " + filename);
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) {
+            mapped = true; // pusty plik: pusty widok (mmap nie przyjmuje długości 0)
+        } else {
+            void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const uint8_t*>(p);
+                mapped = true;
+                ::madvise(p, length, MADV_SEQUENTIAL);
+            } else {
+                length = 0;
+            }
+        }
+    }
+    ::close(fd); // mapowanie pozostaje ważne po zamknięciu deskryptora
+#else
+    (void)filename;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef HUFFMAN_HAVE_MMAP
+    if (view) ::munmap(const_cast<uint8_t*>(view), length);
+#endif
+}
+
+void MappedFile::release(size_t offset, size_t size) {
+#ifdef HUFFMAN_HAVE_MMAP
+    if (!view) return;
+
+    // madvise działa na całych stronach: zwalniamy tylko strony leżące w całości w zakresie.
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = std::min(offset + size, length) / page * page;
+    if (begin < end) ::madvise(const_cast<uint8_t*>(view) + begin, end - begin, MADV_DONTNEED);
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) {
+#ifdef HUFFMAN_HAVE_MMAP
+    if (!view || offset >= length) return;
+
+    // Początek zaokrąglamy w dół do strony (madvise wymaga adresu wyrównanego do strony).
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    size_t end = std::min(offset + size, length);
+    ::madvise(const_cast<uint8_t*>(view) + begin, end - begin, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
+
+// Czyta wszystko, co zostało w strumieniu, kawałkami po 64 KB (rozmiaru potoku nie znamy z góry).
+static std::vector<uint8_t> readAllChunks(InputStream& input) {
+    constexpr size_t CHUNK = 1u << 16;
+    std::vector<uint8_t> bytes;
+    size_t got = 0;
+    do {
+        size_t have = bytes.size();
+        bytes.resize(have + CHUNK);
+        got = input.read(bytes.data() + have, CHUNK);
+        bytes.resize(have + got);
+    } while (got > 0);
+    return bytes;
+}
+
+std::string readTextFromFile(const std::string& filename) {
+    // Czytamy cały plik 1:1 jako bajty: z mapowania jednym kopiowaniem,
+    // a bez mmap dużymi kawałkami (nie znak po znaku przez istreambuf_iterator).
+    MappedFile mapped(filename);
+    if (mapped.isMapped()) {
+        return std::string(reinterpret_cast<const char*>(mapped.data()), mapped.size());
     }
 
+    InputStream file(filename);
+    std::vector<uint8_t> bytes = readAllChunks(file);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+void writeTextToFile(const std::string& filename, const std::string& text) {
+    // Zapisujemy dokładnie tyle bajtów, ile ma tekst (bez żadnych modyfikacji).
+    OutputStream file(filename);
+    file.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    file.close();
+}
+
+uint64_t writeCompressedFile(const std::string& filename,
+                             const std::unordered_map<char, std::string>& codes,
+                             const std::vector<uint8_t>& data,
+                             uint32_t bitCount) {
+
+    OutputStream output(filename);
+    std::ostream& file = output.get();
+    uint64_t size = sizeof(uint32_t) * 2 + data.size();
+
     // 1) Rozmiar słownika
     uint32_t dictSize = static_cast<uint32_t>(codes.size());
     file.write(reinterpret_cast<char*>(&dictSize), sizeof(dictSize));
@@ -51,6 +221,7 @@ void writeCompressedFile(const std::string& filename,
         file.write(reinterpret_cast<char*>(&codeLen), sizeof(codeLen));
 
         file.write(code.data(), codeLen);
+        size += 2 + codeLen;
     }
 
     // 3) Liczba ważnych bitów (pozwala dekoderowi pominąć zera dopchane w ostatnim bajcie)
@@ -61,51 +232,81 @@ void writeCompressedFile(const std::string& filename,
         file.write(reinterpret_cast<const char*>(data.data()),
                    static_cast<std::streamsize>(data.size()));
     }
+    output.close();
+    return size;
 }
 
-CompressedData readCompressedFile(const std::string& filename) {
-    // Odczyt zgodnie z formatem z writeCompressedFile + walidacja (wyjątek, jeśli plik ucięty/uszkodzony).
-    std::ifstream file(filename, std::ios::binary);
+std::vector<uint8_t> readBinaryFile(const std::string& filename) {
+    if (isStdStream(filename)) {
+        InputStream input(filename);
+        return readAllChunks(input);
+    }
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file) {
         throw std::runtime_error("Nie mozna otworzyc pliku: " + filename);
     }
 
-    CompressedData cd;
+    std::streamsize size = file.tellg();
+    file.seekg(0);
 
-    // 1) dictSize
-    uint32_t dictSize;
-    file.read(reinterpret_cast<char*>(&dictSize), sizeof(dictSize));
-    if (!file) throw std::runtime_error("Uszkodzony plik: brak dictSize");
+    std::vector<uint8_t> bytes(static_cast<size_t>(size));
+    if (size > 0 && !file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+        throw std::runtime_error("Blad odczytu pliku: " + filename);
+    }
+    return bytes;
+}
 
-    // 2) Słownik (czytamy do reverseDict: "101" -> 'a')
-    for (uint32_t i = 0; i < dictSize; ++i) {
-        char ch;
-        uint8_t codeLen;
+void writeBinaryFile(const std::string& filename, const std::vector<uint8_t>& bytes) {
+    OutputStream file(filename);
+    file.write(bytes);
+    file.close();
+}
+
+CompressedData parseCompressedData(const uint8_t* bytes, size_t size) {
+    // Odczyt zgodnie z formatem z writeCompressedFile + walidacja (wyjątek, jeśli plik ucięty/uszkodzony).
+    ByteReader in(bytes, size);
+    CompressedData cd;
+
+    // 1) Sygnatura formatu kanonicznego albo dictSize starego formatu
+    uint8_t format = detectFormat(bytes, size);
+    uint32_t dictSize = 0;
 
-        file.read(&ch, sizeof(char));
-        file.read(reinterpret_cast<char*>(&codeLen), sizeof(codeLen));
-        if (!file) throw std::runtime_error("Uszkodzony plik: blad slownika");
+    if (format == FORMAT_CANONICAL) {
+        in.bytes(4);
+        cd.canonical = true;
+        cd.codeLengths = readCodeLengths(in);
+    } else if (format == 0) {
+        dictSize = in.u32();
+    } else {
+        throw std::runtime_error("Nieobslugiwana wersja formatu pliku");
+    }
 
-        std::string code(codeLen, '0');
-        file.read(code.data(), codeLen);
-        if (!file) throw std::runtime_error("Uszkodzony plik: blad slownika");
+    // 2) Słownik starego formatu (czytamy do reverseDict: "101" -> 'a')
+    for (uint32_t i = 0; i < dictSize; ++i) {
+        char ch = static_cast<char>(in.u8());
+        uint8_t codeLen = in.u8();
 
-        cd.reverseDict[code] = ch;
+        const uint8_t* code = in.bytes(codeLen);
+        cd.reverseDict[std::string(code, code + codeLen)] = ch;
     }
 
     // 3) bitCount
-    file.read(reinterpret_cast<char*>(&cd.bitCount), sizeof(cd.bitCount));
-    if (!file) throw std::runtime_error("Uszkodzony plik: brak bitCount");
+    cd.bitCount = in.u32();
 
     // 4) Dane: liczba bajtów to zaokrąglenie w górę liczby bitów do bajtów
-    size_t byteCount = (cd.bitCount + 7) / 8;
-    cd.data.resize(byteCount);
-
-    if (byteCount > 0) {
-        file.read(reinterpret_cast<char*>(cd.data.data()),
-                  static_cast<std::streamsize>(byteCount));
-        if (!file) throw std::runtime_error("Uszkodzony plik: dane binarne");
-    }
+    size_t byteCount = (static_cast<size_t>(cd.bitCount) + 7) / 8;
+    const uint8_t* data = in.bytes(byteCount);
+    cd.data.assign(data, data + byteCount);
 
     return cd;
-}
\ No newline at end of file
+}
+
+CompressedData readCompressedFile(const std::string& filename) {
+    // Parsujemy prosto z mapowania – bez kopii całego pliku.
+    MappedFile mapped(filename);
+    if (mapped.isMapped()) return parseCompressedData(mapped.data(), mapped.size());
+
+    std::vector<uint8_t> bytes = readBinaryFile(filename);
+    return parseCompressedData(bytes.data(), bytes.size());
+}
@@ -1,15 +1,115 @@
 #ifndef IO_H
 #define IO_H
 
+#include "canonical.h"
+#include "format.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 // Dane potrzebne do dekompresji (wczytywane z pliku skompresowanego).
 struct CompressedData {
-    std::unordered_map<std::string, char> reverseDict; // "010" -> znak
+    bool canonical = false;                            // format kanoniczny (same długości kodów)
+    CodeLengths codeLengths{};                         // format kanoniczny: długość kodu każdego bajtu
+    std::unordered_map<std::string, char> reverseDict; // stary format: "010" -> znak
     std::vector<uint8_t> data;                         // bajty strumienia bitów
-    uint32_t bitCount;                                 // liczba ważnych bitów (bez paddingu)
+    uint32_t bitCount = 0;                             // liczba ważnych bitów (bez paddingu)
+};
+
+// Nazwa pliku "-" oznacza standardowe wejście / wyjście (praca w potoku).
+bool isStdStream(const std::string& filename);
+
+/*
+  Źródło danych do czytania kawałkami: plik albo stdin (dla "-").
+  Pozwala przetwarzać dane dowolnej wielkości buforami o stałym rozmiarze.
+*/
+class InputStream {
+private:
+    std::ifstream file;
+    std::istream* stream;
+    std::string name;
+
+public:
+    explicit InputStream(const std::string& filename);
+
+    std::istream& get() { return *stream; }
+
+    // Czyta do n bajtów; zwraca ile przeczytano (mniej niż n tylko na końcu danych).
+    size_t read(uint8_t* dst, size_t n);
+
+    // Wraca na początek danych (potoku nie da się przewinąć).
+    void rewind();
+    [[nodiscard]] bool seekable() const { return stream == &file; }
+};
+
+/*
+  Miejsce zapisu: plik, stdout (dla "-") albo bufor w pamięci:
+  - wektor – dane są dopisywane na koniec (pamięć rośnie w miarę potrzeby),
+  - bufor wywołującego o stałej pojemności – zapis ponad nią to błąd.
+*/
+class OutputStream {
+private:
+    std::ofstream file;
+    std::ostream* stream = nullptr;
+    std::string name;
+    std::vector<uint8_t>* vector = nullptr;
+    uint8_t* fixed = nullptr;
+    size_t capacity = 0;
+    uint64_t count = 0; // liczba zapisanych bajtów
+
+public:
+    explicit OutputStream(const std::string& filename);
+    explicit OutputStream(std::vector<uint8_t>& buffer) : vector(&buffer) {}
+    OutputStream(uint8_t* buffer, size_t capacity) : fixed(buffer), capacity(capacity) {}
+
+    // Strumień pliku/stdout (tylko dla zapisu do pliku).
+    std::ostream& get() { return *stream; }
+
+    [[nodiscard]] uint64_t written() const { return count; }
+
+    void write(const uint8_t* data, size_t size);
+    void write(const std::vector<uint8_t>& bytes) { write(bytes.data(), bytes.size()); }
+
+    // Wypycha bufor (dane trafiają od razu do pliku / potoku) i sprawdza błędy zapisu.
+    void flush();
+
+    // Koniec zapisu: flush() i sprawdzenie, czy wszystkie zapisy się udały.
+    void close();
+};
+
+/*
+  Plik wejściowy zmapowany w pamięci (mmap) – widok tylko do odczytu, bez kopiowania.
+  System wczytuje strony dopiero przy pierwszym dostępie (z podpowiedzią, że czytamy
+  po kolei), więc "otwarcie" nawet bardzo dużego pliku trwa milisekundy.
+  Gdy mapowanie się nie uda (stdin, potok, system bez mmap), isMapped() = false
+  i wywołujący czyta dane zwykłym InputStream.
+*/
+class MappedFile {
+private:
+    const uint8_t* view = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool isMapped() const { return mapped; }
+    [[nodiscard]] const uint8_t* data() const { return view; }
+    [[nodiscard]] size_t size() const { return length; }
+
+    // Zakres [offset, offset + size) nie będzie już czytany – system może zwolnić jego strony.
+    void release(size_t offset, size_t size);
+
+    // Zakres [offset, offset + size) będzie wkrótce czytany – system może wczytać jego strony w tle.
+    void prefetch(size_t offset, size_t size);
 };
 
 // Czyta cały plik tekstowy (1:1 w trybie binary).
@@ -18,13 +118,22 @@ std::string readTextFromFile(const std::string& filename);
 // Zapisuje tekst do pliku (1:1 w trybie binary).
 void writeTextToFile(const std::string& filename, const std::string& text);
 
-// Zapisuje plik skompresowany: słownik + bitCount + dane binarne.
-void writeCompressedFile(const std::string& filename,
-                         const std::unordered_map<char, std::string>& codes,
-                         const std::vector<uint8_t>& data,
-                         uint32_t bitCount);
+// Zapisuje plik skompresowany (stary format): słownik + bitCount + dane binarne; zwraca rozmiar.
+uint64_t writeCompressedFile(const std::string& filename,
+                             const std::unordered_map<char, std::string>& codes,
+                             const std::vector<uint8_t>& data,
+                             uint32_t bitCount);
+
+// Czyta cały plik binarny do pamięci.
+std::vector<uint8_t> readBinaryFile(const std::string& filename);
+
+// Zapisuje bufor do pliku binarnego.
+void writeBinaryFile(const std::string& filename, const std::vector<uint8_t>& bytes);
+
+// Odczytuje plik jednostrumieniowy (stary format albo kanoniczny) z bufora w pamięci.
+CompressedData parseCompressedData(const uint8_t* bytes, size_t size);
 
-// Wczytuje plik skompresowany do struktury CompressedData.
+// Wczytuje plik jednostrumieniowy (stary format albo kanoniczny) do struktury CompressedData.
 CompressedData readCompressedFile(const std::string& filename);
 
 #endif
\ No newline at end of file
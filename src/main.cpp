@@ -1,11 +1,18 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include <exception>
 #include <fstream>
 #include <limits>
 #include <filesystem>
+#include <cstdint>
+#include <iomanip>
 
 #include "huffman.h"
+#include "demo.h"
+#include "batch.h"
+#include "dictionary.h"
+#include "stats.h"
 
 namespace fs = std::filesystem;
 
@@ -44,14 +51,263 @@ std::string ensureExtension(const std::string& name, const std::string& ext) {
     return name + ext;
 }
 
+// Ścieżka z argumentu: katalog + rozszerzenie, a "-" (stdin/stdout) bez zmian.
+std::string argPath(const std::string& name, const std::string& ext, const std::string& dir) {
+    if (name == "-") return name;
+    return dir + "/" + ensureExtension(name, ext);
+}
+
 void printUsage(const char* prog) {
     std::cout
         << "Uzycie:\n"
-        << "  " << prog << " compress <input.txt> <output.huf>\n"
-        << "  " << prog << " decompress <input.huf> <output.txt>\n"
+        << "  " << prog << " compress <input.txt> <output.huf> [opcje]\n"
+        << "  " << prog << " decompress <input.huf> <output.txt> [--threads=N] [--stats[=json]]\n"
+        << "  " << prog << " compress-dir <katalog_wej> <katalog_wyj> [opcje]\n"
+        << "  " << prog << " decompress-dir <katalog_wej> <katalog_wyj> [--threads=N] [--stats[=json]]\n"
+        << "  " << prog << " extract <input.huf> <offset> <dlugosc> [--threads=N] [--dict=PLIK] [--stats[=json]]\n"
+        << "  " << prog << " train <slownik.hdic> <probka>... [--max-len=N]\n"
         << "  " << prog << " heap-demo\n\n"
         << "Kompresja:   input/*.txt  -> output/*.huf\n"
-        << "Dekompresja: output/*.huf -> output/*.txt\n";
+        << "Dekompresja: output/*.huf -> output/*.txt\n"
+        << "Tryb katalogowy: wszystkie pliki (rekurencyjnie) rownolegle, --threads=N plikow naraz;\n"
+        << "  kompresja a/b.txt -> a/b.txt.huf, dekompresja a/b.txt.huf -> a/b.txt\n"
+        << "Fragment:    output/*.huf -> stdout (bajty [offset, offset + dlugosc) danych, mozna z K/M/G)\n"
+        << "Nazwa \"-\" oznacza stdin/stdout (np. cat a.txt | " << prog << " compress - - > a.huf)\n\n"
+        << "Opcje kompresji:\n"
+        << "  --algorithm=A    static (domyslnie) albo adaptive (adaptacyjny Huffman, jedno przejscie)\n"
+        << "  --legacy         stary format (slownik z kodami jako tekst '0'/'1')\n"
+        << "  --max-len=N      limit dlugosci kodu w bitach (1.." << MAX_CODE_LENGTH
+        << ", domyslnie " << DEFAULT_MAX_CODE_LENGTH << ")\n"
+        << "  --block-size=N   rozmiar bloku w bajtach, mozna z K/M (domyslnie 1M)\n"
+        << "  --shared-table   jedna tablica kodow dla wszystkich blokow\n"
+        << "  --streams=N      niezalezne strumienie w bloku, dekodowane naprzemiennie (domyslnie "
+        << DEFAULT_STREAMS << ")\n"
+        << "  --order=N        0 (domyslnie) albo 1 – tablice kodow zalezne od poprzedniego bajtu\n"
+        << "  --symbol-bits=N  8 (domyslnie) albo 16 – bloki moga kodowac pary bajtow (alfabet 65536\n"
+        << "                   symboli; lepsze dla tekstu, blok dostaje mniejszy z dwoch zapisow)\n"
+        << "  --seek-interval=N punkt dostepu dla 'extract' co najwyzej co N bajtow (mozna z K/M)\n"
+        << "  --checksum       CRC32C kazdego bloku i calych danych, sprawdzane przy dekompresji\n"
+        << "  --threads=N      liczba watkow (domyslnie liczba rdzeni)\n"
+        << "  --dict=PLIK      kody ze slownika z 'train' (w pliku tylko ID slownika; tez przy dekompresji)\n"
+        << "  --stats[=F]      czasy faz i liczniki po zakonczeniu: text (domyslnie) albo json\n"
+        << "                   (tez przy dekompresji)\n\n"
+        << "Trening slownika: probki to pliki albo katalogi (rekurencyjnie), sciezki bez zmian;\n"
+        << "  --max-len=N w zakresie 8.." << MAX_CODE_LENGTH << "\n";
+}
+
+// Liczba całkowita z wartości opcji (np. "--max-len=12" -> 12).
+int parseNumber(const std::string& value, const std::string& option) {
+    size_t used = 0;
+    int number = 0;
+    try {
+        number = std::stoi(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::runtime_error("Niepoprawna wartosc opcji: " + option);
+    }
+    return number;
+}
+
+// Rozmiar w bajtach z opcjonalnym przyrostkiem K/M (np. "256K" -> 262144).
+uint32_t parseSize(const std::string& value, const std::string& option) {
+    std::string digits = value;
+    uint64_t unit = 1;
+    if (!digits.empty() && (digits.back() == 'K' || digits.back() == 'k')) unit = 1024;
+    if (!digits.empty() && (digits.back() == 'M' || digits.back() == 'm')) unit = 1024 * 1024;
+    if (unit != 1) digits.pop_back();
+
+    int number = parseNumber(digits, option);
+    uint64_t size = static_cast<uint64_t>(number) * unit;
+    if (number <= 0 || size > UINT32_MAX) {
+        throw std::runtime_error("Niepoprawna wartosc opcji: " + option);
+    }
+    return static_cast<uint32_t>(size);
+}
+
+// Pozycja albo długość w bajtach (64 bity) z opcjonalnym przyrostkiem K/M/G (np. "4K" -> 4096).
+uint64_t parseOffset(const std::string& value, const std::string& what) {
+    std::string digits = value;
+    int shift = 0;
+    if (!digits.empty() && (digits.back() == 'K' || digits.back() == 'k')) shift = 10;
+    if (!digits.empty() && (digits.back() == 'M' || digits.back() == 'm')) shift = 20;
+    if (!digits.empty() && (digits.back() == 'G' || digits.back() == 'g')) shift = 30;
+    if (shift != 0) digits.pop_back();
+
+    size_t used = 0;
+    uint64_t number = 0;
+    try {
+        if (!digits.empty() && digits[0] != '-') number = std::stoull(digits, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != digits.size() || number > (UINT64_MAX >> shift)) {
+        throw std::runtime_error("Niepoprawna wartosc: " + what);
+    }
+    return number << shift;
+}
+
+// Liczba wątków z opcji --threads=N (N >= 1).
+unsigned parseThreads(const std::string& arg) {
+    int threads = parseNumber(arg.substr(10), arg);
+    if (threads < 1) throw std::runtime_error("Niepoprawna wartosc opcji: " + arg);
+    return static_cast<unsigned>(threads);
+}
+
+// --stats[=text|json]: zapamiętuje format wydruku statystyk; false = to nie ta opcja.
+bool parseStatsOption(const std::string& arg, std::string& statsFormat) {
+    if (arg == "--stats" || arg == "--stats=text") {
+        statsFormat = "text";
+    } else if (arg == "--stats=json") {
+        statsFormat = "json";
+    } else if (arg.rfind("--stats=", 0) == 0) {
+        throw std::runtime_error("Niepoprawna wartosc opcji: " + arg);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Czyta opcje kompresji podane po nazwach plików (argv[first..argc-1]).
+CompressOptions parseCompressOptions(int argc, char* argv[], int first, std::string& statsFormat) {
+    CompressOptions options;
+
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--algorithm=static") {
+            options.algorithm = ALGORITHM_STATIC;
+        } else if (arg == "--algorithm=adaptive") {
+            options.algorithm = ALGORITHM_ADAPTIVE;
+        } else if (arg == "--legacy") {
+            options.legacyFormat = true;
+        } else if (arg.rfind("--max-len=", 0) == 0) {
+            options.maxCodeLength = parseNumber(arg.substr(10), arg);
+        } else if (arg.rfind("--block-size=", 0) == 0) {
+            options.blockSize = parseSize(arg.substr(13), arg);
+        } else if (arg == "--shared-table") {
+            options.sharedTable = true;
+        } else if (arg.rfind("--streams=", 0) == 0) {
+            int streams = parseNumber(arg.substr(10), arg);
+            if (streams < 1) throw std::runtime_error("Niepoprawna wartosc opcji: " + arg);
+            options.streams = static_cast<unsigned>(streams);
+        } else if (arg.rfind("--seek-interval=", 0) == 0) {
+            options.seekInterval = parseSize(arg.substr(16), arg);
+        } else if (arg == "--checksum") {
+            options.checksum = true;
+        } else if (arg.rfind("--order=", 0) == 0) {
+            options.contextOrder = parseNumber(arg.substr(8), arg);
+        } else if (arg.rfind("--symbol-bits=", 0) == 0) {
+            options.symbolBits = parseNumber(arg.substr(14), arg);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            options.threads = parseThreads(arg);
+        } else if (arg.rfind("--dict=", 0) == 0) {
+            options.dictionary = arg.substr(7);
+        } else if (!parseStatsOption(arg, statsFormat)) {
+            throw std::runtime_error("Nieznana opcja: " + arg);
+        }
+    }
+
+    return options;
+}
+
+// Czyta opcje dekompresji podane po nazwach plików.
+DecompressOptions parseDecompressOptions(int argc, char* argv[], int first, std::string& statsFormat) {
+    DecompressOptions options;
+
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--threads=", 0) == 0) {
+            options.threads = parseThreads(arg);
+        } else if (arg.rfind("--dict=", 0) == 0) {
+            options.dictionary = arg.substr(7);
+        } else if (!parseStatsOption(arg, statsFormat)) {
+            throw std::runtime_error("Nieznana opcja: " + arg);
+        }
+    }
+
+    return options;
+}
+
+// Komunikaty na stderr, gdy wynik idzie na stdout (żeby nie mieszać ich z danymi).
+std::ostream& statusStream(const std::string& outputFile) {
+    return outputFile == "-" ? std::cerr : std::cout;
+}
+
+void printLengthLimitReport(std::ostream& out, const LengthLimitReport& report, int maxLen) {
+    if (report.longest == 0) return;
+
+    uint64_t extra = report.limitedBits - report.unboundedBits;
+    double loss = 100.0 * static_cast<double>(extra) / static_cast<double>(report.unboundedBits);
+    out << "Limit dlugosci kodu " << maxLen << " bitow (bez limitu: " << report.longest
+        << "): +" << extra << " bitow danych (+"
+        << std::fixed << std::setprecision(3) << loss << "%) wzgledem Huffmana bez ograniczen\n";
+}
+
+void printStats(std::ostream& out, const Stats& stats, const std::string& format) {
+    if (format == "json") {
+        writeStatsJson(out, stats);
+    } else {
+        writeStatsText(out, stats);
+    }
+}
+
+// Kompresja pliku z komunikatami dla użytkownika (biblioteka sama nic nie wypisuje).
+void runCompress(const std::string& in, const std::string& out, const CompressOptions& options = {}) {
+    CompressStats stats = compressFile(in, out, options);
+
+    std::ostream& status = statusStream(out);
+    printLengthLimitReport(status, stats.lengthLimit, options.maxCodeLength);
+    if (stats.inputBytes == 0) {
+        status << "Pusty plik – zapisano pusty plik skompresowany\n";
+    } else {
+        status << "OK: kompresja zakonczona\n";
+    }
+}
+
+void runDecompress(const std::string& in, const std::string& out, const DecompressOptions& options = {}) {
+    decompressFile(in, out, options);
+    statusStream(out) << "OK: dekompresja zakonczona\n";
+}
+
+// train <slownik> <probka>... [--max-len=N]: próbki to pliki albo katalogi.
+int runTrain(int argc, char* argv[]) {
+    std::string output = argv[2];
+    std::vector<std::string> samples;
+    int maxLen = DEFAULT_MAX_CODE_LENGTH;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--max-len=", 0) == 0) {
+            maxLen = parseNumber(arg.substr(10), arg);
+        } else if (arg.rfind("--", 0) == 0) {
+            throw std::runtime_error("Nieznana opcja: " + arg);
+        } else {
+            samples.push_back(arg);
+        }
+    }
+
+    uint64_t sampleBytes = 0;
+    Dictionary dictionary = trainDictionary(samples, maxLen, &sampleBytes);
+    saveDictionary(output, dictionary);
+    std::cout << "OK: slownik " << std::hex << std::setw(8) << std::setfill('0') << dictionary.id << std::dec
+              << " zapisany do " << output << " (probki: " << sampleBytes << " B)\n";
+    return 0;
+}
+
+// Podsumowanie trybu katalogowego; błędy poszczególnych plików na stderr.
+int printBatchResult(const BatchResult& result) {
+    for (const BatchError& error : result.errors) {
+        std::cerr << "Blad: " << error.path << ": " << error.message << "\n";
+    }
+
+    double mb = static_cast<double>(result.rawBytes) / (1024.0 * 1024.0);
+    std::cout << "Pliki: " << result.files << " (bledy: " << result.errors.size() << "), "
+              << "dane: " << result.rawBytes << " B, .huf: " << result.packedBytes << " B, "
+              << std::fixed << std::setprecision(3) << result.seconds << " s, "
+              << std::setprecision(1) << (result.seconds > 0 ? mb / result.seconds : 0.0) << " MB/s\n";
+    return result.errors.empty() ? 0 : 1;
 }
 
 void createFileWithContent(const std::string& filename) {
@@ -73,6 +329,10 @@ void createFileWithContent(const std::string& filename) {
 }
 
 int main(int argc, char* argv[]) {
+    // Własne bufory iostream dla stdin/stdout: szybsze potoki i odczyt tego, co już napłynęło
+    // (readsome), zamiast pojedynczych znaków przez stdio.
+    std::ios::sync_with_stdio(false);
+
     try {
         ensureDirectories();
 
@@ -129,7 +389,7 @@ int main(int argc, char* argv[]) {
                 out = ensureExtension(out, ".huf");
                 out = outPath(out);
 
-                compressFile(in, out);
+                runCompress(in, out);
             }
             else {
                 in = ensureExtension(in, ".huf");
@@ -145,7 +405,7 @@ int main(int argc, char* argv[]) {
                 out = ensureExtension(out, ".txt");
                 out = outPath(out);
 
-                decompressFile(in, out);
+                runDecompress(in, out);
             }
 
             return 0;
@@ -158,7 +418,7 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        if (argc != 4) {
+        if (argc < 4) {
             printUsage(argv[0]);
             return 1;
         }
@@ -166,25 +426,65 @@ int main(int argc, char* argv[]) {
         std::string in  = argv[2];
         std::string out = argv[3];
 
-        if (mode == "compress") {
-            in  = ensureExtension(in, ".txt");
-            out = ensureExtension(out, ".huf");
+        if (mode == "train") return runTrain(argc, argv);
 
-            in  = inPath(in);
-            out = outPath(out);
+        // Statystyki (--stats) zbieramy tylko na życzenie – bez nich biblioteka nie mierzy niczego.
+        Stats stats;
+        std::string statsFormat;
 
-            compressFile(in, out);
+        // extract <plik.huf> <offset> <dlugosc>: fragment danych na stdout (komunikaty na stderr).
+        if (mode == "extract") {
+            if (argc < 5) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            in = argPath(in, ".huf", OUTPUT_DIR);
+            uint64_t offset = parseOffset(argv[3], "offset");
+            uint64_t length = parseOffset(argv[4], "dlugosc");
+
+            DecompressOptions options = parseDecompressOptions(argc, argv, 5, statsFormat);
+            if (!statsFormat.empty()) options.stats = &stats;
+            extractFile(in, offset, length, "-", options);
+            if (!statsFormat.empty()) printStats(std::cerr, stats, statsFormat);
             return 0;
         }
 
-        if (mode == "decompress") {
-            in  = ensureExtension(in, ".huf");
-            out = ensureExtension(out, ".txt");
+        // Katalogi podajemy wprost (bez dopisywania input/ i output/).
+        if (mode == "compress-dir") {
+            CompressOptions options = parseCompressOptions(argc, argv, 4, statsFormat);
+            if (!statsFormat.empty()) options.stats = &stats;
+            int code = printBatchResult(compressDirectory(argv[2], argv[3], options));
+            if (!statsFormat.empty()) printStats(std::cout, stats, statsFormat);
+            return code;
+        }
 
-            in  = outPath(in);
-            out = outPath(out);
+        if (mode == "decompress-dir") {
+            DecompressOptions options = parseDecompressOptions(argc, argv, 4, statsFormat);
+            if (!statsFormat.empty()) options.stats = &stats;
+            int code = printBatchResult(decompressDirectory(argv[2], argv[3], options));
+            if (!statsFormat.empty()) printStats(std::cout, stats, statsFormat);
+            return code;
+        }
+
+        if (mode == "compress") {
+            in  = argPath(in, ".txt", INPUT_DIR);
+            out = argPath(out, ".huf", OUTPUT_DIR);
+
+            CompressOptions options = parseCompressOptions(argc, argv, 4, statsFormat);
+            if (!statsFormat.empty()) options.stats = &stats;
+            runCompress(in, out, options);
+            if (!statsFormat.empty()) printStats(statusStream(out), stats, statsFormat);
+            return 0;
+        }
+
+        if (mode == "decompress") {
+            in  = argPath(in, ".huf", OUTPUT_DIR);
+            out = argPath(out, ".txt", OUTPUT_DIR);
 
-            decompressFile(in, out);
+            DecompressOptions options = parseDecompressOptions(argc, argv, 4, statsFormat);
+            if (!statsFormat.empty()) options.stats = &stats;
+            runDecompress(in, out, options);
+            if (!statsFormat.empty()) printStats(statusStream(out), stats, statsFormat);
             return 0;
         }
 
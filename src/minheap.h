@@ -1,117 +1,158 @@
 #ifndef MINHEAP_H
 #define MINHEAP_H
 
-#include <stdexcept>
+#include <cstddef>
 #include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 /*
   MinHeap (kopiec minimalny) przechowywany w tablicy.
 
-  Reprezentacja indeksowa drzewa binarnego:
-  - parent(i) = (i - 1) / 2
-  - left(i)   = 2*i + 1
-  - right(i)  = 2*i + 2
+  Reprezentacja indeksowa drzewa d-arnego (Arity = d, domyślnie 2):
+  - parent(i) = (i - 1) / d
+  - dzieci(i) = d*i + 1 ... d*i + d
 
   Porządek elementów definiuje funkcja 'less(a,b)' (czy a ma wyższy priorytet niż b).
+  - Compare to typ porównania: domyślnie wskaźnik na funkcję (jak dawniej), ale może to być
+    obiekt funkcyjny – wtedy kompilator wstawia porównanie w heapifyUp/heapifyDown,
+  - Arity = 4 daje płytszy kopiec, a dzieci węzła leżą obok siebie w pamięci
+    (mniej poziomów w extractMin kosztem kilku porównań więcej na poziom),
+  - elementy są przenoszone (std::move), więc T może być typem tylko-do-przenoszenia.
 */
-template <typename T>
+template <typename T, typename Compare = bool (*)(const T&, const T&), size_t Arity = 2>
 class MinHeap {
+    static_assert(Arity >= 2, "Kopiec musi miec co najmniej 2 dzieci na wezel");
+
 private:
-    T* data;
-    int size;
-    int capacity;
-    bool (*less)(const T&, const T&);
+    std::vector<T> data;
+    size_t capacity;
+    Compare less;
 
     // Naprawa kopca po operacjach, które mogą "podnieść" element (insert, decreaseKey).
-    void heapifyUp(int index) {
+    // Zamiast zamian przesuwamy rodziców w dół i wstawiamy element raz, na końcu.
+    void heapifyUp(size_t index) {
+        T value = std::move(data[index]);
         while (index > 0) {
-            int parent = (index - 1) / 2;
-            if (!less(data[index], data[parent])) break;
-            std::swap(data[index], data[parent]);
+            size_t parent = (index - 1) / Arity;
+            if (!less(value, data[parent])) break;
+            data[index] = std::move(data[parent]);
             index = parent;
         }
+        data[index] = std::move(value);
     }
 
     // Naprawa kopca po operacjach, które mogą "opuścić" element (extractMin, buildFromArray/heapify).
-    void heapifyDown(int index) {
+    void heapifyDown(size_t index) {
+        const size_t size = data.size();
+        T value = std::move(data[index]);
         while (true) {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int smallest = index;
+            size_t first = Arity * index + 1;
+            if (first >= size) break;
 
-            if (left < size && less(data[left], data[smallest])) smallest = left;
-            if (right < size && less(data[right], data[smallest])) smallest = right;
+            // Najmniejsze z (co najwyżej) Arity dzieci.
+            size_t last = first + Arity < size ? first + Arity : size;
+            size_t smallest = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (less(data[child], data[smallest])) smallest = child;
+            }
 
-            if (smallest == index) break;
+            if (!less(data[smallest], value)) break;
 
-            std::swap(data[index], data[smallest]);
+            data[index] = std::move(data[smallest]);
             index = smallest;
         }
+        data[index] = std::move(value);
     }
 
-public:
-    // Tworzy kopiec o zadanej pojemności; cmp definiuje "mniejsze" (priorytet).
-    MinHeap(int capacity, bool (*cmp)(const T&, const T&))
-        : data(nullptr), size(0), capacity(capacity), less(cmp) {
-        if (capacity <= 0) throw std::runtime_error("Invalid capacity");
-        data = new T[capacity];
+    void heapify() {
+        if (data.size() < 2) return;
+        for (size_t i = (data.size() - 2) / Arity + 1; i-- > 0;) {
+            heapifyDown(i);
+        }
     }
 
-    ~MinHeap() {
-        delete[] data;
+public:
+    // Tworzy kopiec o zadanej pojemności; cmp definiuje "mniejsze" (priorytet).
+    explicit MinHeap(size_t capacity, Compare cmp = Compare())
+        : capacity(capacity), less(std::move(cmp)) {
+        if (capacity == 0) throw std::runtime_error("Invalid capacity");
+        data.reserve(capacity);
     }
 
-    [[nodiscard]] bool isEmpty() const { return size == 0; }
-    [[nodiscard]] int getSize() const { return size; }
+    [[nodiscard]] bool isEmpty() const { return data.empty(); }
+    [[nodiscard]] size_t getSize() const { return data.size(); }
 
     // Wstawia element i przywraca własność kopca (O(log n)).
     void insert(const T& value) {
-        if (size == capacity) throw std::runtime_error("Heap overflow");
-        data[size] = value;
-        heapifyUp(size);
-        size++;
+        if (data.size() == capacity) throw std::runtime_error("Heap overflow");
+        data.push_back(value);
+        heapifyUp(data.size() - 1);
+    }
+
+    void insert(T&& value) {
+        if (data.size() == capacity) throw std::runtime_error("Heap overflow");
+        data.push_back(std::move(value));
+        heapifyUp(data.size() - 1);
+    }
+
+    // Podgląd elementu minimalnego (bez usuwania).
+    [[nodiscard]] const T& peekMin() const {
+        if (isEmpty()) throw std::runtime_error("Heap is empty");
+        return data[0];
     }
 
     // Zwraca i usuwa element minimalny (korzeń) (O(log n)).
     T extractMin() {
         if (isEmpty()) throw std::runtime_error("Heap is empty");
-        T min = data[0];
-        data[0] = data[size - 1];
-        size--;
-        if (size > 0) heapifyDown(0);
+        T min = std::move(data[0]);
+        if (data.size() > 1) {
+            data[0] = std::move(data.back());
+            data.pop_back();
+            heapifyDown(0);
+        } else {
+            data.pop_back();
+        }
         return min;
     }
 
     // Buduje kopiec z tablicy: heapify od ostatniego rodzica w dół (klasycznie O(n)).
-    void buildFromArray(const T* arr, int n) {
-        if (n < 0 || n > capacity)
+    void buildFromArray(const T* arr, size_t n) {
+        if (n > capacity)
             throw std::runtime_error("Invalid array size");
 
-        for (int i = 0; i < n; i++) data[i] = arr[i];
-        size = n;
+        data.assign(arr, arr + n);
+        heapify();
+    }
 
-        for (int i = (size / 2) - 1; i >= 0; i--) {
-            heapifyDown(i);
-        }
+    // To samo, ale elementy są przenoszone z wektora (także typy tylko-do-przenoszenia).
+    void buildFromArray(std::vector<T>&& values) {
+        if (values.size() > capacity)
+            throw std::runtime_error("Invalid array size");
+
+        data.clear();
+        for (T& value : values) data.push_back(std::move(value));
+        heapify();
     }
 
     // Zmniejsza "klucz" / priorytet elementu na danym indeksie i naprawia kopiec w górę.
-    void decreaseKey(int index, const T& newValue) {
-        if (index < 0 || index >= size)
+    void decreaseKey(size_t index, T newValue) {
+        if (index >= data.size())
             throw std::runtime_error("Index out of range");
         if (!less(newValue, data[index]))
             throw std::runtime_error("New value does not decrease priority");
 
-        data[index] = newValue;
+        data[index] = std::move(newValue);
         heapifyUp(index);
     }
 
     // Pomocnicze wypisanie aktualnej zawartości kopca (kolejność tablicowa, nie "posortowana").
     void debugPrint(const std::function<void(const T&)>& printer) const {
-        for (int i = 0; i < size; i++) {
-            printer(data[i]);
+        for (const T& value : data) {
+            printer(value);
         }
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,182 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+  Kolejka jeden producent – jeden konsument o stałej pojemności (bufor cykliczny).
+
+  Pozycje zapisu i odczytu są atomowe: push i pop nie biorą blokady, dopóki jest
+  miejsce / są dane. Mutex i zmienna warunkowa służą tylko do uśpienia wątku przy
+  pełnej albo pustej kolejce – etapy potoku czekają na dysk albo na kodowanie całej
+  porcji, więc aktywne czekanie tylko zabierałoby rdzeń wątkom kodującym.
+  close() = producent nie doda już nic (pop zwraca false po opróżnieniu kolejki),
+  abort() = przerwanie pracy (push i pop od razu zwracają false).
+*/
+template <typename T>
+class SpscQueue {
+private:
+    std::vector<T> ring;
+    std::atomic<size_t> head{0}; // następny element do pobrania (konsument)
+    std::atomic<size_t> tail{0}; // następne wolne miejsce (producent)
+    std::atomic<bool> closed{false};
+    std::atomic<bool> aborted{false};
+    std::atomic<int> sleepers{0};
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    /*
+        Czeka, aż ready() będzie prawdą; false = kolejka przerwana.
+        Zanim wątek zaśnie, zwiększa 'sleepers' i jeszcze raz sprawdza warunek, a druga
+        strona zmienia pozycję przed odczytem 'sleepers' (kolejność sekwencyjna) – więc
+        albo wątek zobaczy zmianę, albo druga strona zobaczy, że trzeba go obudzić.
+    */
+    template <typename Ready>
+    bool waitUntil(Ready&& ready) {
+        if (ready() || aborted.load()) return !aborted.load();
+        std::unique_lock<std::mutex> lock(mutex);
+        sleepers.fetch_add(1);
+        changed.wait(lock, [&] { return ready() || aborted.load(); });
+        sleepers.fetch_sub(1);
+        return !aborted.load();
+    }
+
+    void wakeUp() {
+        if (sleepers.load() == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+
+public:
+    explicit SpscQueue(size_t capacity) : ring(capacity) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Dodaje element (czeka na miejsce); false = kolejka przerwana.
+    bool push(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (!waitUntil([&] { return t - head.load() < ring.size(); })) return false;
+        ring[t % ring.size()] = std::move(value);
+        tail.store(t + 1);
+        wakeUp();
+        return true;
+    }
+
+    // Pobiera element (czeka na dane); false = kolejka zamknięta i pusta albo przerwana.
+    bool pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (!waitUntil([&] { return tail.load() != h || closed.load(); })) return false;
+        if (tail.load() == h) return false;
+        value = std::move(ring[h % ring.size()]);
+        head.store(h + 1);
+        wakeUp();
+        return true;
+    }
+
+    void close() {
+        closed.store(true);
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+
+    void abort() {
+        aborted.store(true);
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+};
+
+/*
+  Potok trzech etapów na 'depth' porcjach (numery 0..depth-1) używanych na zmianę:
+
+    read(porcja) -> process(porcja) -> write(porcja)
+
+  read działa na osobnym wątku (odczyt wejścia), process na wątku wołającym (który
+  rozdziela pracę na pulę wątków), write na osobnym wątku (zapis wyniku). Porcje krążą
+  przez kolejki SpscQueue (wolne -> do przetworzenia -> do zapisu -> wolne), więc write
+  dostaje je w kolejności read. Gdy process koduje porcję k, read wypełnia k + 1,
+  a write zapisuje k - 1 – czas porcji to max(odczyt, kodowanie, zapis), a nie ich suma.
+
+  read zwraca false przy ostatniej porcji (ta też przechodzi dalej, może być pusta).
+  Pierwszy wyjątek z dowolnego etapu przerywa pozostałe i jest rzucany dalej.
+  Z pipelined = false etapy wykonują się po kolei na wątku wołającym – dla danych
+  mieszczących się w jednej porcji wątki potoku nie miałyby czego nakładać.
+*/
+template <typename Read, typename Process, typename Write>
+void runPipeline(size_t depth, bool pipelined, Read&& read, Process&& process, Write&& write) {
+    if (!pipelined) {
+        bool more = true;
+        while (more) {
+            more = read(size_t{0});
+            process(size_t{0});
+            write(size_t{0});
+        }
+        return;
+    }
+
+    SpscQueue<size_t> empty(depth), filled(depth), processed(depth);
+    for (size_t i = 0; i < depth; ++i) empty.push(i);
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = e;
+        }
+        empty.abort();
+        filled.abort();
+        processed.abort();
+    };
+
+    std::thread reader([&] {
+        try {
+            size_t batch = 0;
+            bool more = true;
+            while (more && empty.pop(batch)) {
+                more = read(batch);
+                if (!filled.push(batch)) return;
+            }
+            filled.close();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    std::thread writer([&] {
+        try {
+            size_t batch = 0;
+            while (processed.pop(batch)) {
+                write(batch);
+                if (!empty.push(batch)) return;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    try {
+        size_t batch = 0;
+        while (filled.pop(batch)) {
+            process(batch);
+            if (!processed.push(batch)) break;
+        }
+        processed.close();
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    reader.join();
+    writer.join();
+    if (error) std::rethrow_exception(error);
+}
+
+#endif
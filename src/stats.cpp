@@ -0,0 +1,86 @@
+#include "stats.h"
+
+#include <cmath>
+#include <iomanip>
+
+const char* phaseName(StatsPhase phase) {
+    static const char* const NAMES[STATS_PHASES] = {"read",   "histogram", "tree",     "tables",
+                                                    "encode", "decode",    "checksum", "write", "total"};
+    return NAMES[phase];
+}
+
+double entropyBits(const Histogram& freq) {
+    uint64_t total = 0;
+    for (uint64_t f : freq) total += f;
+    if (total == 0) return 0.0;
+
+    // Suma f * log2(total / f) = total * log2(total) - suma f * log2(f).
+    double bits = static_cast<double>(total) * std::log2(static_cast<double>(total));
+    for (uint64_t f : freq) {
+        if (f > 0) bits -= static_cast<double>(f) * std::log2(static_cast<double>(f));
+    }
+    return bits > 0 ? bits : 0.0;
+}
+
+void Stats::addCoded(const Histogram& freq, uint64_t size, uint64_t bits) {
+    add(symbols, size);
+    add(codedBits, bits);
+    add(entropyMilliBits, static_cast<uint64_t>(std::llround(1000.0 * entropyBits(freq))));
+}
+
+static double load(const std::atomic<uint64_t>& value) {
+    return static_cast<double>(value.load(std::memory_order_relaxed));
+}
+
+// Średnia liczba bitów na symbol (0 bez symboli).
+static double perSymbol(double bits, const Stats& stats) {
+    double symbols = load(stats.symbols);
+    return symbols > 0 ? bits / symbols : 0.0;
+}
+
+void writeStatsText(std::ostream& out, const Stats& stats) {
+    double input = load(stats.inputBytes);
+    double output = load(stats.outputBytes);
+
+    out << std::fixed << std::setprecision(3) << "Statystyki (czas faz = suma po watkach):\n";
+    for (int p = 0; p < STATS_PHASES; ++p) {
+        out << "  " << std::left << std::setw(10) << phaseName(static_cast<StatsPhase>(p)) << std::right
+            << std::setw(12) << load(stats.phaseNanos[p]) / 1e6 << " ms\n";
+    }
+    out << "  wejscie: " << stats.inputBytes.load() << " B, wyjscie: " << stats.outputBytes.load() << " B";
+    if (input > 0) out << " (" << std::setprecision(2) << 100.0 * output / input << "%)";
+    out << "\n";
+    out << "  bloki: " << stats.blocks.load() << " (surowe: " << stats.rawBlocks.load()
+        << ", RLE: " << stats.rleBlocks.load() << ", pary bajtow: " << stats.wideBlocks.load() << ")\n";
+    out << "  symbole Huffmana: " << stats.symbols.load() << ", srednia dlugosc kodu: " << std::setprecision(4)
+        << perSymbol(load(stats.codedBits), stats) << " bit/symbol";
+    if (stats.entropyMilliBits.load() > 0) {
+        out << ", entropia order-0: " << perSymbol(load(stats.entropyMilliBits) / 1000.0, stats) << " bit/symbol";
+    }
+    out << "\n";
+    out << "  najwieksze bufory porcji: " << stats.peakBuffer.load() << " B\n";
+    out << std::defaultfloat;
+}
+
+void writeStatsJson(std::ostream& out, const Stats& stats) {
+    out << std::fixed << std::setprecision(3) << "{\"phases_ms\": {";
+    for (int p = 0; p < STATS_PHASES; ++p) {
+        out << (p ? ", " : "") << "\"" << phaseName(static_cast<StatsPhase>(p)) << "\": "
+            << load(stats.phaseNanos[p]) / 1e6;
+    }
+    out << "}, \"input_bytes\": " << stats.inputBytes.load() << ", \"output_bytes\": " << stats.outputBytes.load()
+        << ", \"blocks\": " << stats.blocks.load() << ", \"raw_blocks\": " << stats.rawBlocks.load()
+        << ", \"rle_blocks\": " << stats.rleBlocks.load() << ", \"wide_blocks\": " << stats.wideBlocks.load()
+        << ", \"symbols\": " << stats.symbols.load()
+        << ", \"coded_bits\": " << stats.codedBits.load() << std::setprecision(4)
+        << ", \"bits_per_symbol\": " << perSymbol(load(stats.codedBits), stats)
+        << ", \"entropy_bits_per_symbol\": ";
+    // Entropię zna tylko koder (z histogramów) – przy dekompresji null.
+    if (stats.entropyMilliBits.load() > 0) {
+        out << perSymbol(load(stats.entropyMilliBits) / 1000.0, stats);
+    } else {
+        out << "null";
+    }
+    out << ", \"peak_buffer_bytes\": " << stats.peakBuffer.load() << "}\n";
+    out << std::defaultfloat;
+}
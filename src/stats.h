@@ -0,0 +1,96 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "histogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/*
+  Pomiary etapów kodeka (--stats): czasy faz i liczniki.
+
+  Wywołujący tworzy obiekt Stats i podaje wskaźnik w opcjach kompresji/dekompresji;
+  bez niego (nullptr) pomiary kosztują jedno porównanie wskaźnika na fazę bloku –
+  nie ma odczytów zegara ani zapisów do wspólnych liczników.
+  Bloki (i pliki trybu katalogowego) są przetwarzane na wielu wątkach, więc liczniki
+  są atomowe, a czasy faz to suma czasów wszystkich wątków (nie czas zegarowy).
+*/
+enum StatsPhase {
+    PHASE_READ,      // wczytanie wejścia (bloki, nagłówki, dane bloków przy dekompresji)
+    PHASE_HISTOGRAM, // zliczanie częstotliwości
+    PHASE_TREE,      // drzewo / długości kodów (z limitem), wybór modelu bloku
+    PHASE_TABLES,    // tablice kodujące i dekodujące
+    PHASE_ENCODE,    // kodowanie symboli
+    PHASE_DECODE,    // dekodowanie symboli
+    PHASE_CHECKSUM,  // sumy kontrolne CRC32C (--checksum)
+    PHASE_WRITE,     // zapis wyniku
+    PHASE_TOTAL      // całe wywołanie (compressFile, Compressor::compress, ...)
+};
+
+constexpr int STATS_PHASES = PHASE_TOTAL + 1;
+
+// Nazwa fazy w wydruku (np. "encode").
+const char* phaseName(StatsPhase phase);
+
+struct Stats {
+    std::atomic<uint64_t> phaseNanos[STATS_PHASES] = {};
+    std::atomic<uint64_t> inputBytes{0};
+    std::atomic<uint64_t> outputBytes{0};
+    std::atomic<uint64_t> blocks{0};        // wszystkie bloki formatu blokowego
+    std::atomic<uint64_t> rawBlocks{0};     // w tym BLOCK_RAW
+    std::atomic<uint64_t> rleBlocks{0};     // w tym BLOCK_RLE
+    std::atomic<uint64_t> wideBlocks{0};    // w tym BLOCK_WIDE (pary bajtów)
+    std::atomic<uint64_t> symbols{0};       // symbole kodowane Huffmanem (bez bloków RAW/RLE)
+    std::atomic<uint64_t> codedBits{0};     // bity danych tych symboli (bez nagłówków i tablic)
+    std::atomic<uint64_t> entropyMilliBits{0}; // entropia order-0 tych symboli (w 1/1000 bitu)
+    std::atomic<uint64_t> peakBuffer{0};    // największa łączna pamięć buforów porcji (bajty)
+
+    void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void recordPeak(uint64_t bytes) {
+        uint64_t current = peakBuffer.load(std::memory_order_relaxed);
+        while (bytes > current && !peakBuffer.compare_exchange_weak(current, bytes, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Symbole zakodowane Huffmanem: ich liczba, bity i entropia z histogramu.
+    void addCoded(const Histogram& freq, uint64_t size, uint64_t bits);
+};
+
+/*
+  Mierzy czas od utworzenia do końca zakresu i dodaje go do fazy.
+  Z stats == nullptr nic nie robi (nie czyta nawet zegara).
+*/
+class ScopedTimer {
+public:
+    ScopedTimer(Stats* stats, StatsPhase phase) : stats(stats), phase(phase) {
+        if (stats) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (!stats) return;
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        stats->add(stats->phaseNanos[phase], static_cast<uint64_t>(nanos.count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stats* stats;
+    StatsPhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Entropia order-0 histogramu: najmniejsza liczba bitów danych przy kodzie zależnym tylko od symbolu.
+double entropyBits(const Histogram& freq);
+
+// Wydruk statystyk: czytelny tekst albo jeden obiekt JSON.
+void writeStatsText(std::ostream& out, const Stats& stats);
+void writeStatsJson(std::ostream& out, const Stats& stats);
+
+#endif
@@ -0,0 +1,96 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+unsigned ThreadPool::resolveThreads(unsigned threads) {
+    if (threads > 0) return threads;
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+ThreadPool::ThreadPool(unsigned threads) {
+    // Wątek wołający też pracuje w parallelFor, więc startujemy o jeden wątek mniej.
+    unsigned extra = resolveThreads(threads) - 1;
+    for (unsigned i = 0; i < extra; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+
+    // Jeden indeks albo brak dodatkowych wątków: bez synchronizacji.
+    if (count == 1 || workers.empty()) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    struct Shared {
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t running = 0;
+        std::exception_ptr error;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    auto work = [shared, count, &fn] {
+        while (true) {
+            size_t i = shared->next.fetch_add(1);
+            if (i >= count) break;
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if (!shared->error) shared->error = std::current_exception();
+                shared->next = count; // pozostałych indeksów już nie zaczynamy
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), count - 1);
+    shared->running = helpers;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t h = 0; h < helpers; ++h) {
+            tasks.emplace_back([shared, work] {
+                work();
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if (--shared->running == 0) shared->done.notify_all();
+            });
+        }
+    }
+    wake.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->done.wait(lock, [&] { return shared->running == 0; });
+    if (shared->error) std::rethrow_exception(shared->error);
+}
@@ -0,0 +1,48 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Prosta pula wątków roboczych.
+
+  Wątki startują raz (w konstruktorze) i czekają na zadania w kolejce.
+  parallelFor dzieli pracę na indeksy 0..count-1: wątki puli (i wątek wołający)
+  pobierają kolejne indeksy z licznika atomowego, więc nikt nie czeka bezczynnie,
+  dopóki zostały jakieś bloki.
+*/
+class ThreadPool {
+public:
+    // threads = 0 -> tyle wątków, ile rdzeni (std::thread::hardware_concurrency).
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Wywołuje fn(i) dla i = 0..count-1 i czeka na koniec. Pierwszy wyjątek z fn jest rzucany dalej.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // Liczba wątków wykonujących pracę (wątki puli + wątek wołający).
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Liczba wątków dla opcji --threads (0 = liczba rdzeni, co najmniej 1).
+    static unsigned resolveThreads(unsigned threads);
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif